@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "audio_ingest.h"
+
+#include <string.h>
+
+// Kaiser windowed (beta 4) half-band filter, Q15, non-zero taps from
+// center to the edge, center tap is 0.5, taps sum is exactly 1.0
+// passband: within 0.05 dB up to 0.15 fs, stopband: below -50 dB from
+// 0.35 fs (Q15 rounding included)
+static const int16_t half_band[] = {16384, 10055, -2497, 766, -132};
+
+#define CENTER  ((AUDIO_INGEST_TAPS - 1) / 2)
+
+void half_band_init(struct half_band_decimator* s)
+{
+  s->phase = 0;
+  s->pos = 0;
+  memset(s->delay, 0, sizeof(s->delay));
+}
+
+// filter output for the latest TAPS input samples, oldest first
+static int16_t half_band_out(const int16_t* x)
+{
+  int32_t acc = half_band[0] * x[CENTER];
+  for (int k = 1; k < (int)(sizeof(half_band)/sizeof(half_band[0])); k++)
+    acc += half_band[k] * (x[CENTER - (2*k - 1)] + x[CENTER + (2*k - 1)]);
+  acc = (acc + (1 << 14)) >> 15;
+  if (acc > INT16_MAX) acc = INT16_MAX;
+  if (acc < INT16_MIN) acc = INT16_MIN;
+  return (int16_t)acc;
+}
+
+size_t half_band_decimate(struct half_band_decimator* s, const int16_t* in,
+                          size_t n, int16_t* out)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    // output index never gets ahead of input one, so in-place is fine
+    const int16_t x = in[i];
+    s->delay[s->pos] = x;
+    s->delay[s->pos + AUDIO_INGEST_TAPS] = x;
+    s->pos = s->pos + 1 < AUDIO_INGEST_TAPS ? s->pos + 1 : 0;
+
+    // every second sample, filter state is complete only then
+    if (++s->phase == 2) {
+      s->phase = 0;
+      out[count++] = half_band_out(s->delay + s->pos);
+    }
+  }
+  return count;
+}
+
+void audio_ingest_init(struct audio_ingest* s, uint8_t decimation)
+{
+  s->decimation = decimation == 2 ? 2 : 1;
+  half_band_init(&s->hb);
+}
+
+size_t audio_ingest_process(struct audio_ingest* s, const int16_t* stereo,
+                            size_t ns, int16_t* mono)
+{
+  for (size_t i = 0; i < ns; i++)
+    mono[i] = (int16_t)((stereo[2*i+0] + stereo[2*i+1]) >> 1);
+
+  if (s->decimation != 2)
+    return ns;
+
+  return half_band_decimate(&s->hb, mono, ns, mono);
+}
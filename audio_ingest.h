@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _AUDIO_INGEST_H_
+#define _AUDIO_INGEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// audio input stage, runs right in A2DP data callback, before samples
+// enter the ring buffer: stereo is down-mixed to mono (analysis sums
+// channels anyway), and optionally decimated by 2 with half-band
+// filter, so ring buffer and analysis deal with 2x or 4x less data
+
+// half-band filter length, odd, every second tap except center is 0
+#define AUDIO_INGEST_TAPS   15
+
+// mono decimator by 2, half-band low-pass filter
+struct half_band_decimator {
+  uint8_t phase;        // input samples since the last output one
+  uint8_t pos;          // delay line write position
+  // the last input samples, stored twice, so the latest TAPS of them
+  // are always contiguous: [pos, pos + TAPS)
+  int16_t delay[2*AUDIO_INGEST_TAPS];
+};
+
+// resets state, i.e. the history is silence
+void half_band_init(struct half_band_decimator* s);
+
+// decimates chunk of input, chunks may be of any size, result is the
+// same as for the whole input processed at once
+// in - input samples, n in total
+// out - output, up to (n + 1)/2 samples, may be the same as in
+// returns output samples count
+size_t half_band_decimate(struct half_band_decimator* s, const int16_t* in,
+                          size_t n, int16_t* out);
+
+struct audio_ingest {
+  uint8_t decimation;   // 1 - down-mix only, 2 - also decimate
+  struct half_band_decimator hb;
+};
+
+// resets state, decimation - 1 or 2, other values are treated as 1
+void audio_ingest_init(struct audio_ingest* s, uint8_t decimation);
+
+// processes chunk of input, chunks may be of any size, result is the
+// same as for the whole input processed at once
+// stereo - 16bit stereo input, ns samples (i.e. 2*ns values)
+// mono - output buffer, ns samples, output is up to ns samples
+//        ((ns + 1)/2 if decimated)
+// returns output samples count
+size_t audio_ingest_process(struct audio_ingest* s, const int16_t* stereo,
+                            size_t ns, int16_t* mono);
+
+#endif /* _AUDIO_INGEST_H_ */
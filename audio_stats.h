@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _AUDIO_STATS_H_
+#define _AUDIO_STATS_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// audio path health counters, since boot or the last reset
+// each group has the only writer (A2DP data callback or analysis
+// task), so no locking is needed, readers (BLE) may see values
+// a bit stale or from different moments, it's fine for statistics
+
+struct a2dp_stats {
+  uint32_t packets;           // data callbacks count
+  uint32_t packet_min;        // the smallest packet, bytes
+  uint32_t packet_max;        // the largest packet, bytes
+  uint32_t interval_max_us;   // the longest time between packets,
+                              // within started stream, not pauses
+  uint32_t dropped_bytes;     // bytes ring buffer had no room for
+  uint32_t ring_high_water;   // max ring buffer usage, bytes
+  int64_t last_packet_us;     // the last packet time, 0 - no packets
+                              // since stream start
+};
+
+struct analysis_stats {
+  uint32_t frames;            // analyzed blocks
+  uint32_t timeouts;          // ring buffer receive timeouts, no input
+};
+
+// called for each A2DP data packet
+// len - packet size, bytes
+// now_us - current time, microseconds
+static inline void a2dp_stats_packet(struct a2dp_stats* s, uint32_t len,
+                                     int64_t now_us)
+{
+  if (s->packets == 0 || len < s->packet_min)
+    s->packet_min = len;
+  if (len > s->packet_max)
+    s->packet_max = len;
+
+  if (s->last_packet_us != 0) {
+    const int64_t interval = now_us - s->last_packet_us;
+    if (interval > s->interval_max_us)
+      s->interval_max_us = interval < UINT32_MAX ? (uint32_t)interval : UINT32_MAX;
+  }
+
+  s->last_packet_us = now_us;
+  s->packets++;
+}
+
+// called when A2DP stream starts or is suspended, the next packet
+// doesn't start an interval, so pauses in playback are not counted
+static inline void a2dp_stats_restart(struct a2dp_stats* s)
+{
+  s->last_packet_us = 0;
+}
+
+// called after packet data is sent to ring buffer
+// dropped - bytes ring buffer didn't accept
+// used - ring buffer usage after that, bytes
+static inline void a2dp_stats_ring(struct a2dp_stats* s, uint32_t dropped,
+                                   uint32_t used)
+{
+  s->dropped_bytes += dropped;
+  if (used > s->ring_high_water)
+    s->ring_high_water = used;
+}
+
+static inline void a2dp_stats_reset(struct a2dp_stats* s)
+{
+  memset(s, 0, sizeof(*s));
+}
+
+static inline void analysis_stats_reset(struct analysis_stats* s)
+{
+  memset(s, 0, sizeof(*s));
+}
+
+#endif /* _AUDIO_STATS_H_ */
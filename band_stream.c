@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "band_stream.h"
+
+#include <string.h>
+
+#include "fast_math.h"
+
+static uint8_t quantize(float v)
+{
+  if (!(v > 0))   // NaN too
+    return 0;
+  return v < 255 ? (uint8_t)(v + 0.5f) : 255;
+}
+
+uint8_t band_stream_linear(float level)
+{
+  return quantize(level * 255);
+}
+
+uint8_t band_stream_db(float magnitude)
+{
+  if (!(magnitude > 0))
+    return 0;
+  const float db = 20 * math_log10(magnitude);
+  return quantize((db - BAND_STREAM_DB_MIN) / BAND_STREAM_DB_STEP);
+}
+
+void band_stream_frame_init(struct band_stream_frame* f, const float bars[3],
+                            const float* levels, uint8_t count,
+                            const float* points, uint8_t npoints, bool db)
+{
+  if (count > MAX_SPECTRUM_BANDS)
+    count = MAX_SPECTRUM_BANDS;
+  if (npoints > BAND_STREAM_MAX_POINTS)
+    npoints = BAND_STREAM_MAX_POINTS;
+
+  uint8_t (*q)(float) = db ? band_stream_db : band_stream_linear;
+  uint8_t* v = f->values;
+  for (int i = 0; i < 3; i++)
+    *v++ = q(bars[i]);
+  for (uint8_t i = 0; i < count; i++)
+    *v++ = q(levels[i]);
+  for (uint8_t i = 0; i < npoints; i++)
+    *v++ = band_stream_db(points[i]);
+
+  f->flags = db ? BAND_STREAM_BANDS_DB : 0;
+  f->bands = 3 + count;
+  f->points = npoints;
+}
+
+void band_stream_encoder_reset(struct band_stream_encoder* e)
+{
+  e->seq = 0;
+  e->since_key = 0;
+  e->has_prev = false;
+}
+
+size_t band_stream_encode(struct band_stream_encoder* e,
+                          const struct band_stream_frame* f, bool delta,
+                          uint8_t* packet, size_t max_size)
+{
+  if (max_size <= BAND_STREAM_HEADER_SIZE)
+    return 0;
+
+  // what fits into the packet, that is what client sees
+  struct band_stream_frame cur = *f;
+  const size_t room = max_size - BAND_STREAM_HEADER_SIZE;
+  if (cur.bands > room)
+    cur.bands = room;
+  if (cur.points > room - cur.bands)
+    cur.points = room - cur.bands;
+  if (cur.points < f->points)
+    // spectrum values go after all the bands ones
+    memmove(cur.values + cur.bands, f->values + f->bands, cur.points);
+  const size_t n = cur.bands + cur.points;
+
+  const bool same_layout = e->has_prev &&
+                           e->prev.flags == cur.flags &&
+                           e->prev.bands == cur.bands &&
+                           e->prev.points == cur.points;
+  const bool key = !delta || !same_layout ||
+                   e->since_key + 1 >= BAND_STREAM_KEY_INTERVAL;
+
+  uint8_t* v = packet + BAND_STREAM_HEADER_SIZE;
+  if (key) {
+    memcpy(v, cur.values, n);
+    e->since_key = 0;
+  } else {
+    bool changed = false;
+    for (size_t i = 0; i < n; i++) {
+      v[i] = (uint8_t)(cur.values[i] - e->prev.values[i]);
+      changed |= v[i] != 0;
+    }
+    e->since_key++;
+    if (!changed)
+      return 0;
+  }
+
+  packet[0] = cur.flags | (key ? 0 : BAND_STREAM_DELTA);
+  packet[1] = e->seq++;
+  packet[2] = cur.bands;
+  packet[3] = cur.points;
+
+  e->prev = cur;
+  e->has_prev = true;
+  return BAND_STREAM_HEADER_SIZE + n;
+}
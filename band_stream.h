@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _BAND_STREAM_H_
+#define _BAND_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "filter.h"
+
+// live bands (and optional spectrum) stream, one byte per value
+// packet: 4 bytes header, then bands values, then spectrum values
+//   [0] flags, BAND_STREAM_* below
+//   [1] sequence number, increments with each packet sent
+//   [2] bands count, 3 bands first, then analyzer bands
+//   [3] spectrum points count
+// key packet has values as is, delta packet has (value - previous)
+// modulo 256, it can be applied only to the packet with previous
+// sequence number, so after lost packet client waits for a key one
+
+// bands values are in dB steps, linear otherwise
+#define BAND_STREAM_BANDS_DB  0x01
+// values are deltas from the previous packet
+#define BAND_STREAM_DELTA     0x02
+
+#define BAND_STREAM_HEADER_SIZE   4
+#define BAND_STREAM_MAX_BANDS     (3 + MAX_SPECTRUM_BANDS)
+#define BAND_STREAM_MAX_POINTS    MAX_SPECTRUM_BANDS
+#define BAND_STREAM_MAX_VALUES    (BAND_STREAM_MAX_BANDS + BAND_STREAM_MAX_POINTS)
+#define BAND_STREAM_MAX_PACKET    (BAND_STREAM_HEADER_SIZE + BAND_STREAM_MAX_VALUES)
+
+// dB values: 0 is this level or below, each step is 0.5 dB,
+// 255 is +27.5 dB, room for weighting gains and band levels
+#define BAND_STREAM_DB_MIN    -100.f
+#define BAND_STREAM_DB_STEP   0.5f
+
+// frames between key packets, at most, so client which lost a packet
+// recovers soon, even if nothing changes and no deltas are sent
+#define BAND_STREAM_KEY_INTERVAL  32
+
+// quantized frame, built by analysis, encoded by sender
+struct band_stream_frame {
+  uint8_t flags;        // BAND_STREAM_BANDS_DB or 0
+  uint8_t bands;        // bands values count
+  uint8_t points;       // spectrum values count
+  uint8_t values[BAND_STREAM_MAX_VALUES];
+};
+
+// level in [0,1] (the same range as LEDs show) to 0..255
+uint8_t band_stream_linear(float level);
+
+// magnitude to 0.5 dB steps, see BAND_STREAM_DB_MIN
+uint8_t band_stream_db(float magnitude);
+
+// fills frame with quantized values
+// bars - 3 bands levels
+// levels - analyzer bands levels, count in total, may be 0
+// points - spectrum magnitudes, npoints in total, always in dB
+// db - quantize bands in dB too
+void band_stream_frame_init(struct band_stream_frame* f, const float bars[3],
+                            const float* levels, uint8_t count,
+                            const float* points, uint8_t npoints, bool db);
+
+// sender side state
+struct band_stream_encoder {
+  uint8_t seq;          // the next packet sequence number
+  uint8_t since_key;    // frames encoded since the last key packet
+  bool has_prev;        // prev is valid, delta packet can be sent
+  struct band_stream_frame prev;  // the last sent frame
+};
+
+// (re)starts stream, e.g. on subscription, the next packet is a key one
+void band_stream_encoder_reset(struct band_stream_encoder* e);
+
+// encodes frame into packet
+// delta - send deltas when possible, key packets are sent anyway
+//         each BAND_STREAM_KEY_INTERVAL frames and on layout change
+// max_size - packet size limit (ATT MTU - 3), spectrum and then bands
+//            values which don't fit are dropped
+// returns packet size, 0 if there is nothing to send, i.e. delta
+// packet would be all zeros (sequence number is not used then)
+size_t band_stream_encode(struct band_stream_encoder* e,
+                          const struct band_stream_frame* f, bool delta,
+                          uint8_t* packet, size_t max_size);
+
+#endif /* _BAND_STREAM_H_ */
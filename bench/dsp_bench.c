@@ -0,0 +1,1897 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// host benchmark and accuracy check for the DSP core
+// usage: dsp_bench [--bench] [--check]
+//  --bench - only measure analysis stages timings
+//  --check - only compare fft_real() against reference DFT,
+//             other analysis modes against float engine,
+//             audio ingest (down-mix, decimation) against exact values,
+//             multirate analysis against the tones it is given,
+//             compile-time tables against runtime ones,
+//             fast math approximations against libm and
+//             output stage (colors, envelopes) against exact values,
+//             BLE stream packets against frames they encode
+// both are done if no arguments given, exit code is non-zero
+// if any accuracy check fails
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "audio_ingest.h"
+#include "band_stream.h"
+#include "color_out.h"
+#include "envelope.h"
+#include "fast_math.h"
+#include "filter.h"
+#include "fixed_tables.h"
+#include "multirate.h"
+#include "simple_fft.h"
+#include "spectrum.h"
+
+#define MAX_FFT_SIZE        2048
+#define MAX_SAMPLES_COUNT   (2*MAX_FFT_SIZE)
+
+#define BENCH_SAMPLE_RATE   44100
+// every size processes roughly the same amount of audio
+#define BENCH_TOTAL_SAMPLES (1u << 23)
+#define BENCH_MIN_FRAMES    256
+
+// minimal acceptable signal-to-error ratio, dB
+// single precision FFT typically gives ~130 dB for these sizes
+#define MIN_SNR_RUNTIME_TW  110.0
+
+// max acceptable difference between float and Q15 engines magnitudes,
+// relative to the largest magnitude, see ANALYSIS_ENGINE_Q15 description
+#define MAX_Q15_ERROR       5e-4
+// absolute error floor for Q15 engine with input processed by chunks
+#define MIN_Q15_ERROR       1e-5
+
+// max acceptable difference between runtime and compile-time tables,
+// the latter are calculated in double precision, and rounded once
+#define MAX_TABLE_ERROR     1e-6
+#define MAX_TABLE_ERROR_Q15 1   // LSB
+
+// max acceptable difference between float and pruned engines magnitudes
+// of exactly calculated bins, relative to the largest magnitude
+#define MAX_PRUNED_ERROR    1e-5
+
+// pruned engine high band estimate for single tone vs FFT peak,
+// the estimate is exact for tone at bin center, otherwise FFT peak
+// is lower because of window scalloping loss (1.42 dB for Hann)
+#define MIN_PRUNED_PEAK_RATIO   0.99
+#define MAX_PRUNED_PEAK_RATIO   1.18
+
+// values count used to check and benchmark fast math approximations
+#define MATH_VALUES_COUNT   4096
+
+// max acceptable gamma table error, in 16-bit units, for gamma >= 1:
+// table and result rounding plus linear interpolation
+#define MAX_GAMMA_LUT_ERROR 1.1
+// frames count to average dithered output over
+#define DITHER_FRAMES       4096
+// max acceptable envelope step response error, absolute
+#define MAX_ENVELOPE_ERROR  1e-5
+
+// mono input is rounded to 16 bits once more than stereo one,
+// absolute error floor of mono modes
+#define MIN_MONO_ERROR      1e-5
+
+// half-band decimator gain limits, dB, see audio_ingest.c
+#define MAX_INGEST_PASS_DB  0.05  // deviation below 0.15 fs
+#define MAX_INGEST_STOP_DB  -50   // above 0.35 fs
+
+// multirate analysis, the same as firmware uses
+#define MULTIRATE_BASS_NFFT     256
+#define MULTIRATE_CROSSOVER_HZ  300
+#define MULTIRATE_SAMPLES       (2*MAX_SAMPLES_COUNT)
+// bass branch gain limits, dB, 3 half-band stages
+#define MAX_MULTIRATE_PASS_DB   0.15  // below 0.15 of the last stage rate
+#define MAX_MULTIRATE_STOP_DB   -50   // above 0.35 of the last stage rate
+// tone at bass bin center, decimation and window rounding only
+#define MAX_MULTIRATE_PEAK_DB   0.2
+
+// BLE stream frames to encode, default and the largest ATT MTU
+#define STREAM_FRAMES       2000
+#define STREAM_MTU_SMALL    23
+#define STREAM_MTU_LARGE    247
+
+// typical A2DP data callback chunk, and odd one to check boundaries
+#define BENCH_CHUNK_SAMPLES 128
+#define CHECK_CHUNK_SAMPLES 77
+
+#define count_of(X)     (sizeof(X)/sizeof(X[0]))
+
+static const unsigned int fft_sizes[] = {128, 256, 512, 1024, 2048};
+
+static float fft_tw[2*MAX_FFT_SIZE];
+static uint16_t fft_br[MAX_FFT_SIZE];
+static float window_ks[MAX_SAMPLES_COUNT];
+static int16_t fft_tw_q15[2*MAX_FFT_SIZE];
+static int16_t window_ks_q15[MAX_SAMPLES_COUNT];
+static float spectrum_frs[MAX_FFT_SIZE];
+static float spectrum_wks[MAX_FFT_SIZE];
+static float filterbank_weights[FILTERBANK_MAX_WEIGHTS(MAX_FFT_SIZE)];
+
+static int16_t raw_input[2*MAX_SAMPLES_COUNT];  // 2 channels
+static int16_t mono_input[MAX_SAMPLES_COUNT];   // raw_input down-mixed
+static float fft_io_buffer[MAX_SAMPLES_COUNT];
+static float spectrum_ref[MAX_SAMPLES_COUNT];
+
+static int16_t multirate_input[MULTIRATE_SAMPLES];
+static int16_t multirate_history[2*MULTIRATE_BASS_NFFT];
+static float bass_tw[2*MULTIRATE_BASS_NFFT];
+static uint16_t bass_br[MULTIRATE_BASS_NFFT];
+static float bass_window[2*MULTIRATE_BASS_NFFT];
+static float bass_frs[MULTIRATE_BASS_NFFT];
+static float bass_spectrum[2*MULTIRATE_BASS_NFFT];
+// main spectrum, then merged one, see multirate_merge()
+static float multirate_spectrum[MAX_SAMPLES_COUNT + 2*MULTIRATE_BASS_NFFT];
+
+static double ref_input[MAX_SAMPLES_COUNT];
+static double ref_tw[2*MAX_SAMPLES_COUNT];
+static double ref_output[2*(MAX_FFT_SIZE+1)];
+
+static struct filter_opt f_options = {
+  .level_low = 0.8,
+  .level_mid = 1.25,
+  .level_high = 1.85,
+  .thr_low = 2,
+  .thr_ml = 3,
+  .thr_mh = 18,
+  .thr_high = 19,
+  .band_reduction = BAND_REDUCTION_MAX,
+};
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// deterministic pseudo-random numbers, the same for every run
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng_next(void)
+{
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return rng_state;
+}
+
+// uniform noise in [-1, 1)
+static double rng_noise(void)
+{
+  return (int32_t)rng_next() / 2147483648.0;
+}
+
+// a few tones plus noise, something that resembles music a bit
+static void make_test_signal(double* x, size_t ns)
+{
+  const double pi = acos(-1.0);
+  for (size_t i = 0; i < ns; i++) {
+    double t = (double)i / BENCH_SAMPLE_RATE;
+    x[i] = 0.35 * sin(2*pi*60*t) +
+           0.20 * sin(2*pi*440*t + 0.3) +
+           0.10 * sin(2*pi*5000*t + 1.1) +
+           0.05 * rng_noise();
+  }
+}
+
+// level - signal amplitude, 1.0 is 0 dBFS
+static void make_raw_input(int16_t* raw, size_t ns, double level)
+{
+  make_test_signal(ref_input, ns);
+  for (size_t i = 0; i < ns; i++) {
+    int16_t v = (int16_t)lround(ref_input[i] * level * 32767);
+    raw[2*i+0] = v;
+    raw[2*i+1] = (int16_t)(v / 2);
+  }
+
+  // the same as A2DP data callback does for mono analysis
+  struct audio_ingest ingest;
+  audio_ingest_init(&ingest, 1);
+  audio_ingest_process(&ingest, raw, ns, mono_input);
+}
+
+// mono tone, amplitude is 1.0 for 0 dBFS
+static void make_mono_tone(int16_t* x, size_t ns, double freq, double amp)
+{
+  for (size_t i = 0; i < ns; i++)
+    x[i] = (int16_t)lround(amp * 32767 * sin(2 * M_PI * freq * i / BENCH_SAMPLE_RATE));
+}
+
+// white noise spectrum magnitudes, they are Rayleigh distributed
+static void make_noise_spectrum(float* spectrum, unsigned int nfft)
+{
+  for (unsigned int i = 0; i < nfft; i++) {
+    // uniform in (0, 1]
+    double u = (rng_next() >> 8) / 16777216.0 + 1 / 33554432.0;
+    spectrum[2*i+0] = 0;
+    spectrum[2*i+1] = (float)(0.1 * sqrt(-2 * log(u)));
+  }
+}
+
+// fills all the analysis configuration data for given FFT size
+static void init_analysis(struct analysis_cfg* acfg, simple_fft_cfg* fft_cfg,
+                          simple_fft_q15_cfg* fft_q15_cfg, unsigned int nfft)
+{
+  fft_init(fft_cfg, fft_tw, fft_br, nfft);
+  fft_init_q15(fft_q15_cfg, fft_tw_q15, fft_br, nfft);
+  frequencies_data(spectrum_frs, BENCH_SAMPLE_RATE, nfft);
+
+  acfg->engine = ANALYSIS_ENGINE_FLOAT;
+  acfg->fft_cfg = fft_cfg;
+  acfg->fft_q15_cfg = fft_q15_cfg;
+  acfg->kwnd = window_ks;
+  acfg->kwnd_q15 = window_ks_q15;
+  acfg->freq = spectrum_frs;
+  acfg->preamp = 1.0;
+  acfg->exact_bins = f_options.thr_high;
+  acfg->weights = NULL;
+  acfg->fft_real_fn = NULL;
+  acfg->mono_input = false;
+  acfg->kwnd_sum = window_data(window_ks, 2*nfft, WINDOW_HANN, &acfg->kwnd_sq_sum);
+  window_data_q15(window_ks_q15, 2*nfft, WINDOW_HANN, NULL);
+}
+
+// the same as init_analysis(), but for multirate bass branch,
+// the rest of the configuration is copied from acfg
+static void init_bass_analysis(struct analysis_cfg* bass_acfg, simple_fft_cfg* bass_fft,
+                               const struct analysis_cfg* acfg)
+{
+  fft_init(bass_fft, bass_tw, bass_br, MULTIRATE_BASS_NFFT);
+  frequencies_data(bass_frs, BENCH_SAMPLE_RATE / MULTIRATE_DECIMATION, MULTIRATE_BASS_NFFT);
+
+  *bass_acfg = *acfg;
+  bass_acfg->engine = ANALYSIS_ENGINE_FLOAT;
+  bass_acfg->fft_cfg = bass_fft;
+  bass_acfg->kwnd = bass_window;
+  bass_acfg->freq = bass_frs;
+  bass_acfg->mono_input = true;
+  bass_acfg->kwnd_sum = window_data(bass_window, 2*MULTIRATE_BASS_NFFT, WINDOW_HANN,
+                                    &bass_acfg->kwnd_sq_sum);
+}
+
+// analysis variants, all of them must give the same result within
+// their precision: relative to the largest magnitude, but not less
+// than some absolute value
+struct analysis_mode {
+  const char* name;
+  enum analysis_engine engine;
+  bool chunked;       // input is processed by chunks
+  bool fixed;         // size-specialized FFT is used
+  bool mono;          // input is down-mixed to mono
+  double max_error;
+  double min_error;
+};
+
+static const struct analysis_mode analysis_modes[] = {
+  {"float",     ANALYSIS_ENGINE_FLOAT,  false, false, false, 0,              0},
+  {"q15",       ANALYSIS_ENGINE_Q15,    false, false, false, MAX_Q15_ERROR,  0},
+  {"float/ch",  ANALYSIS_ENGINE_FLOAT,  true,  false, false, 1e-6,           0},
+  {"q15/ch",    ANALYSIS_ENGINE_Q15,    true,  false, false, MAX_Q15_ERROR,  MIN_Q15_ERROR},
+  {"pruned",    ANALYSIS_ENGINE_PRUNED, false, false, false, MAX_PRUNED_ERROR, 0},
+  {"pruned/ch", ANALYSIS_ENGINE_PRUNED, true,  false, false, MAX_PRUNED_ERROR, 0},
+  {"fixed",     ANALYSIS_ENGINE_FLOAT,  false, true,  false, 1e-6,           0},
+  {"fixed/ch",  ANALYSIS_ENGINE_FLOAT,  true,  true,  false, 1e-6,           0},
+  {"mono",      ANALYSIS_ENGINE_FLOAT,  false, false, true,  1e-6,           MIN_MONO_ERROR},
+  {"mono/ch",   ANALYSIS_ENGINE_FLOAT,  true,  true,  true,  1e-6,           MIN_MONO_ERROR},
+  {"q15/mono",  ANALYSIS_ENGINE_Q15,    true,  false, true,  MAX_Q15_ERROR,  MIN_Q15_ERROR},
+};
+
+// chunk - samples count in each chunk, for chunked modes
+static void run_analysis(const struct analysis_mode* mode,
+                         struct analysis_cfg* acfg, size_t chunk,
+                         float* spectrum)
+{
+  acfg->engine = mode->engine;
+  // runtime and compile-time bit-reversal tables are the same,
+  // so input prepared for fft_cfg suits specialized FFT too
+  acfg->fft_real_fn = mode->fixed ?
+                      fixed_fft_get(acfg->fft_cfg->n)->fft_real_bitrev : NULL;
+  acfg->mono_input = mode->mono;
+
+  const int16_t* input = mode->mono ? mono_input : raw_input;
+  const size_t channels = mode->mono ? 1 : 2;
+
+  if (!mode->chunked) {
+    analyze_input(acfg, input, spectrum);
+    acfg->mono_input = false;
+    return;
+  }
+
+  const size_t ns = 2*acfg->fft_cfg->n;
+  for (size_t offset = 0; offset < ns; offset += chunk) {
+    size_t n = ns - offset < chunk ? ns - offset : chunk;
+    prepare_input_chunk(acfg, offset, input + channels*offset, n, spectrum);
+  }
+  analyze_prepared_input(acfg, spectrum);
+  acfg->mono_input = false;
+}
+
+// ----------------------------------------------------------
+//                        benchmark
+// ----------------------------------------------------------
+enum bench_stage {
+  STAGE_PREPARE,
+  STAGE_FFT,
+  STAGE_SPECTRUM,
+  STAGE_FILTER,
+  STAGES_COUNT
+};
+
+static const char* const stage_names[STAGES_COUNT] = {
+  "prepare",
+  "fft",
+  "spectrum",
+  "lmh_out",
+};
+
+static size_t bench_frames(size_t ns)
+{
+  size_t frames = BENCH_TOTAL_SAMPLES / ns;
+  return frames < BENCH_MIN_FRAMES ? BENCH_MIN_FRAMES : frames;
+}
+
+static void bench_size(unsigned int nfft)
+{
+  const size_t ns = 2*nfft;
+  const size_t frames = bench_frames(ns);
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  make_raw_input(raw_input, ns, 1.0);
+  uint16_t bands[6];
+  spectrum_lmh_bands(bands, &f_options, nfft);
+
+  uint64_t total[STAGES_COUNT] = {0};
+  volatile float sink = 0;
+
+  for (size_t f = 0; f < frames; f++) {
+    float bars[3];
+    uint64_t t[STAGES_COUNT + 1];
+    t[0] = now_ns();
+    prepare_fft_input(&acfg, raw_input, fft_io_buffer);
+    t[1] = now_ns();
+    fft_real_bitrev(&fft_cfg, fft_io_buffer);
+    t[2] = now_ns();
+    calculate_spectrum(&acfg, fft_io_buffer);
+    t[3] = now_ns();
+    spectrum_lmh_out(fft_io_buffer, nfft, bars, bands, &f_options, NULL);
+    t[4] = now_ns();
+    sink += bars[0] + bars[1] + bars[2];
+
+    for (int s = 0; s < STAGES_COUNT; s++)
+      total[s] += t[s+1] - t[s];
+  }
+  (void)sink;
+
+  uint64_t sum = 0;
+  printf("%6u %8zu", nfft, ns);
+  for (int s = 0; s < STAGES_COUNT; s++) {
+    printf(" %10.1f", (double)total[s] / frames);
+    sum += total[s];
+  }
+  printf(" %10.1f\n", (double)sum / frames);
+}
+
+// generic FFT vs the one specialized for the size
+static void bench_fixed_fft(unsigned int nfft)
+{
+  const size_t frames = bench_frames(2*nfft);
+
+  simple_fft_cfg fft_cfg;
+  fft_init(&fft_cfg, fft_tw, fft_br, nfft);
+  const struct fixed_fft* fixed = fixed_fft_get(nfft);
+
+  make_test_signal(ref_input, 2*nfft);
+  for (size_t i = 0; i < 2*nfft; i++)
+    spectrum_ref[i] = (float)ref_input[i];
+
+  // input is restored every frame, otherwise it grows with each FFT
+  uint64_t t[2] = {0};
+  for (size_t f = 0; f < frames; f++) {
+    memcpy(fft_io_buffer, spectrum_ref, 2*nfft * sizeof(float));
+    uint64_t t0 = now_ns();
+    fft_real_bitrev(&fft_cfg, fft_io_buffer);
+    uint64_t t1 = now_ns();
+    memcpy(fft_io_buffer, spectrum_ref, 2*nfft * sizeof(float));
+    uint64_t t2 = now_ns();
+    fixed->fft_real_bitrev(fixed->cfg, fft_io_buffer);
+    uint64_t t3 = now_ns();
+    t[0] += t1 - t0;
+    t[1] += t3 - t2;
+  }
+
+  printf("%6u %10.1f %10.1f\n", nfft,
+         (double)t[0] / frames, (double)t[1] / frames);
+}
+
+// 32 bands reduction: the largest magnitude vs filterbank
+static void bench_bands(unsigned int nfft)
+{
+  const size_t frames = bench_frames(2*nfft);
+
+  struct spectrum_bands bands;
+  spectrum_bands_log(&bands, MAX_SPECTRUM_BANDS, 40, 16000, BENCH_SAMPLE_RATE, nfft);
+  struct spectrum_filterbank fb;
+  const size_t nw = spectrum_filterbank_bands(&fb, filterbank_weights, &bands);
+  make_noise_spectrum(fft_io_buffer, nfft);
+
+  float levels[MAX_SPECTRUM_BANDS];
+  volatile float sink = 0;
+  uint64_t t0 = now_ns();
+  for (size_t f = 0; f < frames; f++) {
+    spectrum_bands_out(fft_io_buffer, &bands, levels);
+    sink += levels[0];
+  }
+  uint64_t t1 = now_ns();
+  for (size_t f = 0; f < frames; f++) {
+    spectrum_filterbank_out(fft_io_buffer, &fb, levels);
+    sink += levels[0];
+  }
+  uint64_t t2 = now_ns();
+  (void)sink;
+
+  printf("%6u %8zu %10.1f %10.1f\n", nfft, nw,
+         (double)(t1 - t0) / frames, (double)(t2 - t1) / frames);
+}
+
+static void bench_engines(unsigned int nfft)
+{
+  const size_t ns = 2*nfft;
+  const size_t frames = bench_frames(ns);
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  make_raw_input(raw_input, ns, 1.0);
+
+  printf("%6u %8zu", nfft, ns);
+  for (size_t m = 0; m < count_of(analysis_modes); m++) {
+    uint64_t t0 = now_ns();
+    for (size_t f = 0; f < frames; f++)
+      run_analysis(&analysis_modes[m], &acfg, BENCH_CHUNK_SAMPLES, fft_io_buffer);
+    uint64_t t1 = now_ns();
+    printf(" %10.1f", (double)(t1 - t0) / frames);
+  }
+  printf("\n");
+}
+
+// multirate analysis (full-rate FFT, bass branch, merge) vs full-rate
+// FFT alone, hop is the whole block, i.e. 2*nfft samples, bass bins
+// are the same as full-rate FFT of MULTIRATE_DECIMATION times bass size
+// gives, see bench_size() for it
+static void bench_multirate(unsigned int nfft)
+{
+  const size_t ns = 2*nfft;
+  const size_t frames = bench_frames(ns);
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  make_mono_tone(multirate_input, ns, 100, 0.5);
+
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  acfg.mono_input = true;
+  uint64_t t0 = now_ns();
+  for (size_t f = 0; f < frames; f++)
+    analyze_input(&acfg, multirate_input, multirate_spectrum);
+  uint64_t t1 = now_ns();
+
+  simple_fft_cfg bass_fft;
+  struct analysis_cfg bass_acfg;
+  init_bass_analysis(&bass_acfg, &bass_fft, &acfg);
+  struct multirate_bass bass;
+  multirate_bass_init(&bass, multirate_history, 2*MULTIRATE_BASS_NFFT);
+  struct multirate_layout l;
+  multirate_layout_init(&l, MULTIRATE_CROSSOVER_HZ, BENCH_SAMPLE_RATE / MULTIRATE_DECIMATION,
+                        MULTIRATE_BASS_NFFT, BENCH_SAMPLE_RATE, nfft);
+
+  uint64_t t2 = now_ns();
+  for (size_t f = 0; f < frames; f++) {
+    multirate_bass_push(&bass, multirate_input, ns);
+    analyze_input(&acfg, multirate_input, multirate_spectrum);
+    analyze_input(&bass_acfg, multirate_history, bass_spectrum);
+    multirate_merge(&l, bass_spectrum, multirate_spectrum);
+  }
+  uint64_t t3 = now_ns();
+
+  printf("%6u %10.1f %10.1f\n", nfft,
+         (double)(t1 - t0) / frames, (double)(t3 - t2) / frames);
+}
+
+// ----------------------------------------------------------
+//                fast math approximations
+// ----------------------------------------------------------
+// each function is checked on its own domain, arguments are
+// the same as in the project code: magnitudes, bars and frequencies
+enum math_func {
+  MATH_HYPOT,
+  MATH_LOG10,
+  MATH_LOG,
+  MATH_POW,
+  MATH_LOGLOG,
+  MATH_FUNCS_COUNT
+};
+
+struct math_func_desc {
+  const char* name;
+  bool relative;      // error is relative, otherwise absolute
+  double max_error;
+};
+
+// see fast_math.h
+static const struct math_func_desc math_funcs[MATH_FUNCS_COUNT] = {
+  {"hypot",   true,   3e-7},
+  {"log10",   false,  1e-6},
+  {"log",     false,  2e-6},
+  {"pow",     true,   5e-6},
+  {"loglog",  false,  1e-6},
+};
+
+static float math_x[MATH_VALUES_COUNT];
+static float math_y[MATH_VALUES_COUNT];
+
+// fills arguments for given function
+static void make_math_args(enum math_func f)
+{
+  for (size_t i = 0; i < MATH_VALUES_COUNT; i++) {
+    double r = (double)i / (MATH_VALUES_COUNT - 1);
+    switch (f) {
+      case MATH_HYPOT:    // FFT output values
+        math_x[i] = (float)rng_noise();
+        math_y[i] = (float)rng_noise();
+        break;
+      case MATH_LOG10:    // magnitudes, from noise floor to full scale
+      case MATH_LOG:
+        math_x[i] = (float)pow(10, -7 + 8*r);
+        break;
+      case MATH_POW:      // bars and gamma values
+        math_x[i] = (float)pow(10, -4 + 4*r);
+        math_y[i] = (float)(1 + 3 * (rng_noise() + 1) / 2);
+        break;
+      case MATH_LOGLOG:   // spectrum frequencies
+        math_x[i] = (float)(10 + 24000*r);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+static float call_libm(enum math_func f, float x, float y)
+{
+  switch (f) {
+    case MATH_HYPOT:  return hypotf(x, y);
+    case MATH_LOG10:  return log10f(x);
+    case MATH_LOG:    return logf(x);
+    case MATH_POW:    return powf(x, y);
+    case MATH_LOGLOG: return logf(logf(x));
+    default:          return 0;
+  }
+}
+
+static float call_fast(enum math_func f, float x, float y)
+{
+  switch (f) {
+    case MATH_HYPOT:  return fast_hypot(x, y);
+    case MATH_LOG10:  return fast_log10(x);
+    case MATH_LOG:    return fast_log(x);
+    case MATH_POW:    return fast_pow(x, y);
+    case MATH_LOGLOG: return fast_log(fast_log(x));
+    default:          return 0;
+  }
+}
+
+static double call_reference(enum math_func f, double x, double y)
+{
+  switch (f) {
+    case MATH_HYPOT:  return hypot(x, y);
+    case MATH_LOG10:  return log10(x);
+    case MATH_LOG:    return log(x);
+    case MATH_POW:    return pow(x, y);
+    case MATH_LOGLOG: return log(log(x));
+    default:          return 0;
+  }
+}
+
+// ns per call, the loop is the same for both implementations,
+// function is chosen outside of it to let compiler inline it
+#define BENCH_MATH_LOOP(call)                                   \
+  for (size_t r = 0; r < rounds; r++)                           \
+    for (size_t i = 0; i < MATH_VALUES_COUNT; i++)              \
+      acc += call(f, math_x[i], math_y[i])
+
+static void bench_math_func(enum math_func f)
+{
+  const size_t rounds = BENCH_TOTAL_SAMPLES / MATH_VALUES_COUNT;
+  volatile float sink = 0;
+  float acc = 0;
+  make_math_args(f);
+
+  uint64_t t0 = now_ns();
+  BENCH_MATH_LOOP(call_libm);
+  uint64_t t1 = now_ns();
+  BENCH_MATH_LOOP(call_fast);
+  uint64_t t2 = now_ns();
+  sink = acc;
+  (void)sink;
+
+  const double calls = (double)rounds * MATH_VALUES_COUNT;
+  printf("%-8s %10.2f %10.2f\n", math_funcs[f].name,
+         (t1 - t0) / calls, (t2 - t1) / calls);
+}
+
+static void run_benchmark(void)
+{
+  printf("analysis stages timings, ns/frame\n");
+  printf("%6s %8s", "nfft", "samples");
+  for (int s = 0; s < STAGES_COUNT; s++)
+    printf(" %10s", stage_names[s]);
+  printf(" %10s\n", "total");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    bench_size(fft_sizes[i]);
+
+  printf("\nfft_real_bitrev() generic vs size-specialized, ns/frame\n");
+  printf("%6s %10s %10s\n", "nfft", "generic", "fixed");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    bench_fixed_fft(fft_sizes[i]);
+
+  printf("\n%d bands reduction, ns/frame\n", MAX_SPECTRUM_BANDS);
+  printf("%6s %8s %10s %10s\n", "nfft", "weights", "max", "filterbank");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    bench_bands(fft_sizes[i]);
+
+  printf("\nanalysis by engine, ns/frame\n");
+  printf("%6s %8s", "nfft", "samples");
+  for (size_t m = 0; m < count_of(analysis_modes); m++)
+    printf(" %10s", analysis_modes[m].name);
+  printf("\n");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    bench_engines(fft_sizes[i]);
+
+  printf("\nmultirate analysis, bass FFT %d (bins of %d FFT), ns/frame\n",
+         MULTIRATE_BASS_NFFT, MULTIRATE_DECIMATION * MULTIRATE_BASS_NFFT);
+  printf("%6s %10s %10s\n", "nfft", "full-rate", "multirate");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    bench_multirate(fft_sizes[i]);
+
+  printf("\nmath functions (FAST_MATH_APPROX=%d), ns/call\n", FAST_MATH_APPROX);
+  printf("%-8s %10s %10s\n", "function", "libm", "fast");
+  for (int f = 0; f < MATH_FUNCS_COUNT; f++)
+    bench_math_func((enum math_func)f);
+}
+
+// ----------------------------------------------------------
+//                     accuracy check
+// ----------------------------------------------------------
+// straightforward O(N^2) DFT of ns real values in double precision
+// output is ns/2+1 (re,im) pairs, i.e. non-negative frequencies only
+static void reference_dft(const double* x, size_t ns, double* out)
+{
+  const double pi = acos(-1.0);
+  for (size_t i = 0; i < ns; i++) {
+    ref_tw[2*i+0] = cos(-2*pi*i / ns);
+    ref_tw[2*i+1] = sin(-2*pi*i / ns);
+  }
+
+  for (size_t k = 0; k <= ns/2; k++) {
+    double re = 0;
+    double im = 0;
+    size_t idx = 0;
+    for (size_t i = 0; i < ns; i++) {
+      re += x[i] * ref_tw[2*idx+0];
+      im += x[i] * ref_tw[2*idx+1];
+      idx += k;
+      if (idx >= ns)
+        idx -= ns;
+    }
+    out[2*k+0] = re;
+    out[2*k+1] = im;
+  }
+}
+
+// compares fft_real() output (KISS FFT format) against reference
+// returns signal-to-error ratio in dB, max_err is normalized by max |X|
+static double compare_with_reference(const float* fft, const double* ref,
+                                     unsigned int nfft, double* max_err)
+{
+  double sig = 0;
+  double err = 0;
+  double max_abs = 0;
+  double max_diff = 0;
+
+  for (unsigned int k = 0; k <= nfft; k++) {
+    double re, im;
+    if (k == 0) {
+      re = fft[0];
+      im = 0;
+    } else if (k == nfft) {
+      re = fft[1];
+      im = 0;
+    } else {
+      re = fft[2*k+0];
+      im = fft[2*k+1];
+    }
+
+    double dre = re - ref[2*k+0];
+    double dim = im - ref[2*k+1];
+    double d = hypot(dre, dim);
+    double a = hypot(ref[2*k+0], ref[2*k+1]);
+
+    sig += a * a;
+    err += d * d;
+    if (a > max_abs)
+      max_abs = a;
+    if (d > max_diff)
+      max_diff = d;
+  }
+
+  *max_err = max_diff / max_abs;
+  return err > 0 ? 10 * log10(sig / err) : INFINITY;
+}
+
+// fft - FFT function with fft_real_bitrev() interface, NULL means fft_real()
+static bool check_size(const simple_fft_cfg* fft_cfg,
+                       void (*fft)(const simple_fft_cfg*, float*),
+                       const char* name, double min_snr)
+{
+  const unsigned int nfft = fft_cfg->n;
+  const size_t ns = 2*nfft;
+
+  make_test_signal(ref_input, ns);
+  for (size_t i = 0; i < ns; i++)
+    fft_io_buffer[i] = (float)ref_input[i];
+  // reference uses exactly the same (rounded to float) input
+  for (size_t i = 0; i < ns; i++)
+    ref_input[i] = fft_io_buffer[i];
+
+  if (fft) {
+    // (re,im) pair i goes to br[i]
+    for (size_t i = 0; i < ns; i++)
+      fft_io_buffer[2*fft_cfg->br[i/2] + i%2] = (float)ref_input[i];
+    fft(fft_cfg, fft_io_buffer);
+  } else {
+    fft_real(fft_cfg, fft_io_buffer);
+  }
+  reference_dft(ref_input, ns, ref_output);
+
+  double max_err = 0;
+  double snr = compare_with_reference(fft_io_buffer, ref_output, nfft, &max_err);
+  bool ok = snr >= min_snr;
+
+  printf("%6u %-8s %12.3e %10.1f %8s\n", nfft, name, max_err, snr,
+         ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_accuracy_check(void)
+{
+  printf("fft_real() vs double precision DFT\n");
+  printf("%6s %-8s %12s %10s %8s\n", "nfft", "twiddles", "max error", "SNR, dB", "result");
+
+  bool ok = true;
+  for (size_t i = 0; i < count_of(fft_sizes); i++) {
+    simple_fft_cfg fft_cfg;
+    fft_init(&fft_cfg, fft_tw, NULL, fft_sizes[i]);
+    ok &= check_size(&fft_cfg, NULL, "runtime", MIN_SNR_RUNTIME_TW);
+    fft_init(&fft_cfg, fft_tw, fft_br, fft_sizes[i]);
+    ok &= check_size(&fft_cfg, NULL, "rt+br", MIN_SNR_RUNTIME_TW);
+    const struct fixed_fft* fixed = fixed_fft_get(fft_sizes[i]);
+    ok &= check_size(fixed->cfg, NULL, "compile", MIN_SNR_RUNTIME_TW);
+    ok &= check_size(fixed->cfg, fixed->fft_real_bitrev, "fixed", MIN_SNR_RUNTIME_TW);
+  }
+
+  return ok;
+}
+
+// max absolute difference between float tables
+static double max_diff(const float* a, const float* b, size_t n)
+{
+  double d = 0;
+  for (size_t i = 0; i < n; i++)
+    if (fabs(a[i] - b[i]) > d)
+      d = fabs(a[i] - b[i]);
+  return d;
+}
+
+static double max_diff_q15(const int16_t* a, const int16_t* b, size_t n)
+{
+  int d = 0;
+  for (size_t i = 0; i < n; i++)
+    if (abs(a[i] - b[i]) > d)
+      d = abs(a[i] - b[i]);
+  return d;
+}
+
+static bool print_table_check(unsigned int nfft, const char* name,
+                              double err, double max_error)
+{
+  bool ok = err <= max_error;
+  printf("%6u %-14s %12.3e %8s\n", nfft, name, err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// compares compile-time tables against runtime generated ones
+static bool check_fixed_tables(unsigned int nfft)
+{
+  static const char* const kwnd_names[] = {"hann", "b-harris", "flat-top"};
+  const struct fixed_fft* fixed = fixed_fft_get(nfft);
+  const size_t ns = 2*nfft;
+  bool ok = true;
+
+  simple_fft_cfg fft_cfg;
+  fft_init(&fft_cfg, fft_tw, fft_br, nfft);
+  double tw_err = max_diff(fixed->cfg->tw, fft_cfg.tw, 2*nfft);
+  tw_err = fmax(tw_err, fabs(fixed->cfg->tw_mul_re - fft_cfg.tw_mul_re));
+  tw_err = fmax(tw_err, fabs(fixed->cfg->tw_mul_im - fft_cfg.tw_mul_im));
+  ok &= print_table_check(nfft, "twiddles", tw_err, MAX_TABLE_ERROR);
+  bool br_ok = memcmp(fixed->cfg->br, fft_br, nfft * sizeof(fft_br[0])) == 0;
+  ok &= print_table_check(nfft, "bitrev", br_ok ? 0 : INFINITY, 0);
+
+  simple_fft_q15_cfg fft_q15_cfg;
+  fft_init_q15(&fft_q15_cfg, fft_tw_q15, NULL, nfft);
+  double tw_q15_err = max_diff_q15(fixed->cfg_q15->tw, fft_q15_cfg.tw, 2*nfft);
+  tw_q15_err = fmax(tw_q15_err, abs(fixed->cfg_q15->tw_mul_re - fft_q15_cfg.tw_mul_re));
+  tw_q15_err = fmax(tw_q15_err, abs(fixed->cfg_q15->tw_mul_im - fft_q15_cfg.tw_mul_im));
+  ok &= print_table_check(nfft, "twiddles q15", tw_q15_err, MAX_TABLE_ERROR_Q15);
+
+  for (int w = 0; w < (int)count_of(kwnd_names); w++) {
+    float sq_sum = 0;
+    float sum = window_data(window_ks, ns, (enum window_type)w, &sq_sum);
+    double err = max_diff(fixed->kwnd[w], window_ks, ns);
+    // sums are compared relative to themselves
+    err = fmax(err, fabs(fixed->kwnd_sum[w] - sum) / sum);
+    err = fmax(err, fabs(fixed->kwnd_sq_sum[w] - sq_sum) / sq_sum);
+    ok &= print_table_check(nfft, kwnd_names[w], err, MAX_TABLE_ERROR);
+
+    float sum_q15 = window_data_q15(window_ks_q15, ns, (enum window_type)w, NULL);
+    double err_q15 = max_diff_q15(fixed->kwnd_q15[w], window_ks_q15, ns);
+    bool sum_ok = fabs(fixed->kwnd_q15_sum[w] - sum_q15) / sum_q15 <= MAX_TABLE_ERROR;
+    ok &= print_table_check(nfft, "  q15", sum_ok ? err_q15 : INFINITY,
+                            MAX_TABLE_ERROR_Q15);
+  }
+
+  return ok;
+}
+
+// checks log-spaced bands edges and one pass reduction,
+// reduction is compared against spectrum_bars() of the same bands
+static bool check_bands(unsigned int nfft, uint8_t count)
+{
+  const float f_min = 40;
+  const float f_max = 16000;
+  struct spectrum_bands bands;
+  spectrum_bands_log(&bands, count, f_min, f_max, BENCH_SAMPLE_RATE, nfft);
+  frequencies_data(spectrum_frs, BENCH_SAMPLE_RATE, nfft);
+
+  // edge is the first index with frequency not below requested one,
+  // unless band was widened to one bin, never above the Nyquist
+  bool edges_ok = bands.count == count && bands.edges[count] <= nfft;
+  unsigned int non_empty = 0;
+  for (uint8_t b = 0; b <= count; b++) {
+    const uint16_t e = bands.edges[b];
+    const float f = f_min * powf(f_max / f_min, (float)b / count);
+    const bool widened = b > 0 && e == bands.edges[b-1] + 1;
+    if (e < nfft && spectrum_frs[e] < f && !widened)
+      edges_ok = false;
+    if (e > 0 && e < nfft && spectrum_frs[e-1] >= f && !widened)
+      edges_ok = false;
+    if (b > 0 && e < bands.edges[b-1] + (bands.edges[b-1] < nfft))
+      edges_ok = false;
+    if (b > 0 && e > bands.edges[b-1])
+      non_empty++;
+  }
+
+  make_noise_spectrum(fft_io_buffer, nfft);
+
+  float levels[MAX_SPECTRUM_BANDS];
+  spectrum_bands_out(fft_io_buffer, &bands, levels);
+
+  double max_err = 0;
+  for (uint8_t b = 0; b < count; b++) {
+    float ref = 0;
+    if (bands.edges[b+1] > bands.edges[b]) {
+      const uint16_t range[2] = {bands.edges[b], bands.edges[b+1] - 1};
+      spectrum_bars(1, &ref, range, fft_io_buffer, nfft);
+    }
+    max_err = fmax(max_err, fabs(levels[b] - ref));
+  }
+
+  bool ok = edges_ok && max_err == 0;
+  printf("%6u %6u %10u %12.3e %8s\n", nfft, count, non_empty, max_err,
+         ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// relative standard deviation of the last band level for noise spectrum
+// fb - filterbank to use, NULL means the largest magnitude
+static double level_variation(const struct spectrum_bands* bands,
+                              const struct spectrum_filterbank* fb,
+                              unsigned int nfft)
+{
+  const int frames = 256;
+  double sum = 0;
+  double sum2 = 0;
+  for (int f = 0; f < frames; f++) {
+    float levels[MAX_SPECTRUM_BANDS];
+    make_noise_spectrum(fft_io_buffer, nfft);
+    if (fb)
+      spectrum_filterbank_out(fft_io_buffer, fb, levels);
+    else
+      spectrum_bands_out(fft_io_buffer, bands, levels);
+    sum += levels[bands->count - 1];
+    sum2 += levels[bands->count - 1] * levels[bands->count - 1];
+  }
+  const double mean = sum / frames;
+  return sqrt(fmax(sum2 / frames - mean * mean, 0)) / mean;
+}
+
+// checks filterbank for log-spaced bands and 3 bands ones: weights count
+// is within the limit, every band of flat spectrum has level 1, impulse
+// at band center is seen only by the band and its neighbours, and noise
+// level of the widest band is more stable than with the largest magnitude
+static bool check_filterbank(unsigned int nfft, uint8_t count)
+{
+  struct spectrum_bands bands;
+  spectrum_bands_log(&bands, count, 40, 16000, BENCH_SAMPLE_RATE, nfft);
+
+  struct spectrum_filterbank fb;
+  const size_t nw = spectrum_filterbank_bands(&fb, NULL, &bands);
+  bool ok = nw <= FILTERBANK_MAX_WEIGHTS(nfft);
+  if (!ok) {
+    printf("%6u %6u %8zu %35s\n", nfft, count, nw, "FAIL");
+    return false;
+  }
+  ok &= spectrum_filterbank_bands(&fb, filterbank_weights, &bands) == nw;
+
+  float levels[MAX_SPECTRUM_BANDS];
+  for (unsigned int i = 0; i < nfft; i++) {
+    fft_io_buffer[2*i+0] = 0;
+    fft_io_buffer[2*i+1] = 1;
+  }
+  spectrum_filterbank_out(fft_io_buffer, &fb, levels);
+  double flat_err = 0;
+  for (uint8_t b = 0; b < count; b++)
+    if (bands.edges[b+1] > bands.edges[b])
+      flat_err = fmax(flat_err, fabs(levels[b] - 1));
+
+  bool impulse_ok = true;
+  for (uint8_t b = 0; b < count; b++) {
+    if (bands.edges[b+1] == bands.edges[b])
+      continue;
+    memset(fft_io_buffer, 0, 2*nfft * sizeof(float));
+    fft_io_buffer[2*((bands.edges[b] + bands.edges[b+1] - 1) / 2) + 1] = 1;
+    spectrum_filterbank_out(fft_io_buffer, &fb, levels);
+    for (uint8_t k = 0; k < count; k++) {
+      if (k + 1 < b || k > b + 1)
+        impulse_ok &= levels[k] == 0;
+      impulse_ok &= levels[k] <= levels[b];
+    }
+  }
+
+  // 3 bands filterbank, the same flat spectrum check
+  struct filter_opt opt = f_options;
+  opt.band_reduction = BAND_REDUCTION_FILTERBANK;
+  uint16_t lmh_bands[6];
+  spectrum_lmh_bands(lmh_bands, &opt, nfft);
+  struct spectrum_filterbank lmh_fb;
+  ok &= spectrum_filterbank_lmh(&lmh_fb, NULL, lmh_bands, nfft) <= FILTERBANK_MAX_WEIGHTS(nfft);
+  spectrum_filterbank_lmh(&lmh_fb, filterbank_weights, lmh_bands, nfft);
+  for (unsigned int i = 0; i < nfft; i++) {
+    fft_io_buffer[2*i+0] = 0;
+    fft_io_buffer[2*i+1] = 1;
+  }
+  float bars[3];
+  spectrum_lmh_out(fft_io_buffer, nfft, bars, lmh_bands, &opt, &lmh_fb);
+  flat_err = fmax(flat_err, fabs(bars[0] / opt.level_low - 1));
+  flat_err = fmax(flat_err, fabs(bars[1] / opt.level_mid - 1));
+  flat_err = fmax(flat_err, fabs(bars[2] / opt.level_high - 1));
+
+  spectrum_filterbank_bands(&fb, filterbank_weights, &bands);
+  const double var_max = level_variation(&bands, NULL, nfft);
+  const double var_fb = level_variation(&bands, &fb, nfft);
+
+  ok &= flat_err <= 1e-5 && impulse_ok && var_fb < var_max;
+  printf("%6u %6u %8zu %12.3e %10.3f %10.3f %8s\n", nfft, count, nw,
+         flat_err, var_max, var_fb, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// compares analysis output against float engine one
+// level - input signal amplitude, 1.0 is 0 dBFS
+static bool check_analysis(const struct analysis_mode* mode,
+                           unsigned int nfft, double level)
+{
+  const size_t ns = 2*nfft;
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  make_raw_input(raw_input, ns, level);
+
+  acfg.engine = ANALYSIS_ENGINE_FLOAT;
+  analyze_input(&acfg, raw_input, spectrum_ref);
+  run_analysis(mode, &acfg, CHECK_CHUNK_SAMPLES, fft_io_buffer);
+
+  // pruned engine only estimates the rest of the spectrum
+  const unsigned int nb = mode->engine == ANALYSIS_ENGINE_PRUNED ?
+                          acfg.exact_bins : nfft;
+
+  double max_err = 0;
+  double max_m = 0;
+  for (unsigned int i = 0; i < nb; i++) {
+    double d = fabs(fft_io_buffer[2*i+1] - spectrum_ref[2*i+1]);
+    if (d > max_err)
+      max_err = d;
+    if (spectrum_ref[2*i+1] > max_m)
+      max_m = spectrum_ref[2*i+1];
+  }
+
+  double tolerance = mode->max_error * max_m;
+  if (tolerance < mode->min_error)
+    tolerance = mode->min_error;
+  bool ok = max_err <= tolerance;
+
+  printf("%6u %8.0f %-10s %12.3e %12.3e %8s\n", nfft, 20 * log10(level),
+         mode->name, max_m, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// checks window sum against closed form and single tone amplitude,
+// bin - tone frequency in bins, fractional part is offset from center
+// max_error - acceptable relative error of amplitude
+static bool check_window(unsigned int nfft, enum window_type type,
+                         double bin, double max_error)
+{
+  static const char* const window_names[] = {"hann", "b-harris", "flat-top"};
+  // a[0] and alternating sum of the rest, see window_coefficient()
+  static const double a0[] = {0.5, 0.35875, 0.21557895};
+  static const double a_rest[] = {-0.5, -0.48829 + 0.14128 - 0.01168,
+    -0.41663158 + 0.277263158 - 0.083578947 + 0.006947368};
+
+  const size_t ns = 2*nfft;
+  const double pi = acos(-1.0);
+  const double amplitude = 0.5;
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  acfg.kwnd_sum = window_data(window_ks, ns, type, &acfg.kwnd_sq_sum);
+
+  double sum = a0[type] * ns + a_rest[type];
+  double sum_err = fabs(acfg.kwnd_sum - sum) / sum;
+
+  for (size_t i = 0; i < ns; i++) {
+    double x = amplitude * sin(2*pi*bin*i/ns + 0.4);
+    raw_input[2*i+0] = raw_input[2*i+1] = (int16_t)lround(x * 32767);
+  }
+  analyze_input(&acfg, raw_input, fft_io_buffer);
+
+  double peak = 0;
+  for (unsigned int i = 0; i < nfft; i++)
+    if (fft_io_buffer[2*i+1] > peak)
+      peak = fft_io_buffer[2*i+1];
+  double amp_err = fabs(peak - amplitude) / amplitude;
+
+  bool ok = sum_err <= 1e-6 && amp_err <= max_error;
+  printf("%6u %-10s %8.2f %12.3e %12.3e %8s\n", nfft, window_names[type],
+         bin, sum_err, amp_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// compares pruned engine high band estimate against float engine
+// peak, input is a single tone in the high band plus bass tone
+// freq - high band tone frequency, Hz
+static bool check_pruned_estimate(unsigned int nfft, double freq)
+{
+  const size_t ns = 2*nfft;
+  const double pi = acos(-1.0);
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  for (size_t i = 0; i < ns; i++) {
+    double t = (double)i / BENCH_SAMPLE_RATE;
+    double x = 0.3 * sin(2*pi*60*t) + 0.5 * sin(2*pi*freq*t + 0.7);
+    raw_input[2*i+0] = raw_input[2*i+1] = (int16_t)lround(x * 32767);
+  }
+
+  acfg.engine = ANALYSIS_ENGINE_FLOAT;
+  analyze_input(&acfg, raw_input, spectrum_ref);
+  acfg.engine = ANALYSIS_ENGINE_PRUNED;
+  analyze_input(&acfg, raw_input, fft_io_buffer);
+
+  double peak = 0;
+  for (unsigned int i = acfg.exact_bins; i < nfft; i++)
+    if (spectrum_ref[2*i+1] > peak)
+      peak = spectrum_ref[2*i+1];
+
+  double ratio = fft_io_buffer[2*acfg.exact_bins+1] / peak;
+  bool ok = ratio >= MIN_PRUNED_PEAK_RATIO && ratio <= MAX_PRUNED_PEAK_RATIO;
+
+  printf("%6u %8.0f %12.3e %12.3f %8s\n", nfft, freq, peak, ratio,
+         ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// checks that weights are applied to every magnitude by every mode,
+// it doesn't matter how precise the mode is, result is the same as
+// unweighted one multiplied by weights
+static bool check_weighting(const struct analysis_mode* mode,
+                            unsigned int nfft, enum weighting_curve curve)
+{
+  static const char* const curve_names[] = {"log-log", "A", "flat"};
+
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  weighting_data(spectrum_wks, spectrum_frs, nfft, curve);
+  make_raw_input(raw_input, 2*nfft, 1.0);
+
+  run_analysis(mode, &acfg, CHECK_CHUNK_SAMPLES, spectrum_ref);
+  acfg.weights = spectrum_wks;
+  run_analysis(mode, &acfg, CHECK_CHUNK_SAMPLES, fft_io_buffer);
+
+  double max_err = 0;
+  for (unsigned int i = 0; i < nfft; i++) {
+    double expected = spectrum_ref[2*i+1] * spectrum_wks[i];
+    double d = fabs(fft_io_buffer[2*i+1] - expected);
+    if (expected > 0)
+      d /= expected;
+    if (d > max_err)
+      max_err = d;
+  }
+  bool ok = max_err <= 1e-6;
+
+  printf("%6u %-8s %-10s %12.3e %8s\n", nfft, curve_names[curve],
+         mode->name, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// the lowest bins of the largest FFT with decimated input, frequency
+// axis starts at a few Hz there, weights must be valid and not negative
+static bool check_weighting_low_bins(enum weighting_curve curve)
+{
+  static const char* const curve_names[] = {"log-log", "A", "flat"};
+  static const size_t rates[] = {16000 / 2, BENCH_SAMPLE_RATE / 2};
+  enum { nfft = MAX_FFT_SIZE, nlow = 16 };
+
+  bool ok = true;
+  float min_w = INFINITY;
+  for (size_t r = 0; r < count_of(rates); r++) {
+    frequencies_data(spectrum_frs, rates[r], nfft);
+    // DC too, it is not a part of spectrum, but must not break the curve
+    spectrum_frs[nlow] = 0;
+    weighting_data(spectrum_wks, spectrum_frs, nlow + 1, curve);
+    for (size_t i = 0; i <= nlow; i++) {
+      const float w = spectrum_wks[i];
+      ok &= isfinite(w) && w >= 0;
+      // log-log grows with frequency
+      if (curve == WEIGHTING_LOG_LOG && i > 0 && i < nlow)
+        ok &= w >= spectrum_wks[i-1];
+      if (w < min_w)
+        min_w = w;
+    }
+  }
+
+  printf("%6u %-8s %-10s %12.3e %8s\n", nfft, curve_names[curve],
+         "low bins", min_w, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// BLE allows thresholds up to 255, small FFTs have fewer bins,
+// bands must be limited to spectrum, not left uncalculated
+static bool check_lmh_thresholds(unsigned int nfft, const uint8_t thr[4],
+                                 enum band_reduction reduction)
+{
+  struct filter_opt opt = f_options;
+  opt.thr_low = thr[0];
+  opt.thr_ml = thr[1];
+  opt.thr_mh = thr[2];
+  opt.thr_high = thr[3];
+  opt.band_reduction = reduction;
+
+  uint16_t bands[6];
+  spectrum_lmh_bands(bands, &opt, nfft);
+  struct spectrum_filterbank lmh_fb;
+  const bool use_fb = reduction == BAND_REDUCTION_FILTERBANK;
+  if (use_fb)
+    spectrum_filterbank_lmh(&lmh_fb, filterbank_weights, bands, nfft);
+
+  for (unsigned int i = 0; i < nfft; i++) {
+    fft_io_buffer[2*i+0] = i + 1;
+    fft_io_buffer[2*i+1] = 1;
+  }
+  float bars[3] = {NAN, NAN, NAN};
+  spectrum_lmh_out(fft_io_buffer, nfft, bars, bands, &opt, use_fb ? &lmh_fb : NULL);
+
+  // flat spectrum, every band has at least the last index
+  const float levels[3] = {opt.level_low, opt.level_mid, opt.level_high};
+  double max_err = 0;
+  for (int b = 0; b < 3; b++)
+    max_err = fmax(max_err, isfinite(bars[b]) ? fabs(bars[b] / levels[b] - 1) : INFINITY);
+  const bool ok = max_err <= 1e-5;
+
+  char name[32];
+  snprintf(name, sizeof(name), "%u/%u/%u/%u", thr[0], thr[1], thr[2], thr[3]);
+  printf("%6u %-16s %-10s %12.3e %8s\n", nfft, name, use_fb ? "filterbank" : "max",
+         max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_analysis_check(void)
+{
+  static const double levels[] = {1.0, 0.1, 0.01, 0.001};
+
+  printf("analysis modes vs float engine magnitudes\n");
+  printf("%6s %8s %-10s %12s %12s %8s\n",
+         "nfft", "dBFS", "mode", "max value", "max error", "result");
+
+  bool ok = true;
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    for (size_t l = 0; l < count_of(levels); l++)
+      // the first mode is the reference itself
+      for (size_t m = 1; m < count_of(analysis_modes); m++)
+        ok &= check_analysis(&analysis_modes[m], fft_sizes[i], levels[l]);
+
+  // bin-centered tone (for 512) and arbitrary one
+  static const double tones[] = {BENCH_SAMPLE_RATE * 100.0 / 1024, 7321};
+
+  printf("\nweighted vs unweighted analysis, relative error\n");
+  printf("%6s %-8s %-10s %12s %8s\n", "nfft", "curve", "mode", "max error", "result");
+
+  static const enum weighting_curve curves[] = {
+    WEIGHTING_LOG_LOG, WEIGHTING_A, WEIGHTING_FLAT,
+  };
+  for (size_t c = 0; c < count_of(curves); c++)
+    for (size_t m = 0; m < count_of(analysis_modes); m++)
+      ok &= check_weighting(&analysis_modes[m], 512, curves[c]);
+  for (size_t c = 0; c < count_of(curves); c++)
+    ok &= check_weighting_low_bins(curves[c]);
+
+  printf("\nwindow functions sum and single tone amplitude, relative error\n");
+  printf("%6s %-10s %8s %12s %12s %8s\n", "nfft", "window", "bin", "sum", "amplitude", "result");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++) {
+    // tone at bin center, all windows give exact amplitude
+    ok &= check_window(fft_sizes[i], WINDOW_HANN, 40, 1e-3);
+    ok &= check_window(fft_sizes[i], WINDOW_BLACKMAN_HARRIS, 40, 1e-3);
+    ok &= check_window(fft_sizes[i], WINDOW_FLAT_TOP, 40, 1e-3);
+    // between bins, only flat-top window keeps amplitude (0.02 dB)
+    ok &= check_window(fft_sizes[i], WINDOW_FLAT_TOP, 40.5, 2e-3);
+  }
+
+  printf("\nlog-spaced bands edges and reduction vs spectrum_bars()\n");
+  printf("%6s %6s %10s %12s %8s\n", "nfft", "bands", "non-empty", "max error", "result");
+
+  static const uint8_t band_counts[] = {8, 16, 32};
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    for (size_t b = 0; b < count_of(band_counts); b++)
+      ok &= check_bands(fft_sizes[i], band_counts[b]);
+
+  printf("\nfilterbank flat spectrum error and noise level variation\n");
+  printf("%6s %6s %8s %12s %10s %10s %8s\n", "nfft", "bands", "weights",
+         "flat error", "max var", "fb var", "result");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    for (size_t b = 0; b < count_of(band_counts); b++)
+      ok &= check_filterbank(fft_sizes[i], band_counts[b]);
+
+  printf("\n3 bands with thresholds beyond spectrum, flat spectrum error\n");
+  printf("%6s %-16s %-10s %12s %8s\n", "nfft", "thresholds", "reduction",
+         "max error", "result");
+
+  static const uint8_t thresholds[][4] = {
+    {60, 70, 100, 130}, {10, 20, 30, 200}, {200, 220, 240, 255},
+  };
+  static const unsigned int small_sizes[] = {128, 256};
+  for (size_t i = 0; i < count_of(small_sizes); i++)
+    for (size_t t = 0; t < count_of(thresholds); t++) {
+      ok &= check_lmh_thresholds(small_sizes[i], thresholds[t], BAND_REDUCTION_MAX);
+      ok &= check_lmh_thresholds(small_sizes[i], thresholds[t], BAND_REDUCTION_FILTERBANK);
+    }
+
+  printf("\ncompile-time tables vs runtime ones, max difference\n");
+  printf("%6s %-14s %12s %8s\n", "nfft", "table", "max error", "result");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    ok &= check_fixed_tables(fft_sizes[i]);
+
+  printf("\npruned engine high band estimate vs float engine peak\n");
+  printf("%6s %8s %12s %12s %8s\n", "nfft", "tone, Hz", "peak", "ratio", "result");
+
+  for (size_t i = 0; i < count_of(fft_sizes); i++)
+    for (size_t t = 0; t < count_of(tones); t++)
+      ok &= check_pruned_estimate(fft_sizes[i], tones[t]);
+
+  return ok;
+}
+
+static bool check_math_func(enum math_func f)
+{
+  const struct math_func_desc* desc = &math_funcs[f];
+  make_math_args(f);
+
+  double max_err = 0;
+  bool ok = true;
+  for (size_t i = 0; i < MATH_VALUES_COUNT; i++) {
+    double ref = call_reference(f, math_x[i], math_y[i]);
+    double err = fabs(call_fast(f, math_x[i], math_y[i]) - ref);
+    if (desc->relative)
+      err /= fabs(ref);
+    ok &= err <= desc->max_error;
+    if (err > max_err)
+      max_err = err;
+  }
+
+  printf("%-8s %-8s %12.3e %12.3e %8s\n", desc->name,
+         desc->relative ? "relative" : "absolute",
+         desc->max_error, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_math_check(void)
+{
+  printf("fast math approximations vs double precision libm\n");
+  printf("%-8s %-8s %12s %12s %8s\n",
+         "function", "error", "documented", "max error", "result");
+
+  bool ok = true;
+  for (int f = 0; f < MATH_FUNCS_COUNT; f++)
+    ok &= check_math_func((enum math_func)f);
+  return ok;
+}
+
+static bool check_gamma_lut(float gamma)
+{
+  static struct gamma_lut lut;
+  gamma_lut_init(&lut, gamma);
+
+  double max_err = 0;
+  for (int i = 0; i <= 100000; i++) {
+    const float x = i / 100000.f;
+    const double ref = pow(x, gamma) * UINT16_MAX;
+    const double err = fabs(gamma_lut_apply(&lut, x) - ref);
+    if (err > max_err)
+      max_err = err;
+  }
+
+  bool ok = max_err <= MAX_GAMMA_LUT_ERROR;
+  char name[32];
+  snprintf(name, sizeof(name), "gamma %.1f", gamma);
+  printf("%-16s %12.3f %8s\n", name, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// dithered output must average to the input value over frames
+// and must only toggle between two adjacent output levels
+static bool check_dither(unsigned int bits)
+{
+  const unsigned int shift = 16 - bits;
+  static const uint16_t values[] = {0, 1, 77, 255, 256, 1000, 12345, 65280, 65535};
+
+  double max_err = 0;
+  bool ok = true;
+  for (size_t v = 0; v < count_of(values); v++) {
+    struct dither_channel ch = {0};
+    uint64_t sum = 0;
+    for (int i = 0; i < DITHER_FRAMES; i++) {
+      const uint32_t out = dither_quantize(&ch, values[v], bits);
+      // one of two nearest levels, value rounded down or up
+      const uint32_t low = (uint32_t)(values[v] >> shift);
+      ok &= (out == low) || (out == low + 1);
+      sum += out;
+    }
+    const double max_out = (1u << bits) - 1;
+    // full scale is exact, everything else is in 2^shift units
+    const double mean = values[v] == UINT16_MAX ? sum / (double)DITHER_FRAMES / max_out * UINT16_MAX
+                                                : (double)(sum << shift) / DITHER_FRAMES;
+    const double err = fabs(mean - values[v]);
+    if (err > max_err)
+      max_err = err;
+  }
+
+  // error left in the state is less than one output step
+  ok &= max_err < (double)(1u << shift) / DITHER_FRAMES + 1e-9;
+  char name[32];
+  snprintf(name, sizeof(name), "dither %u bits", bits);
+  printf("%-16s %12.3f %8s\n", name, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// step response of envelope must reach 1 - 1/e in attack time
+// and fall to 1/e in release time
+static bool check_envelope(float attack_ms, float release_ms, float rate_hz)
+{
+  struct envelope_cfg cfg;
+  envelope_init(&cfg, attack_ms, release_ms, rate_hz);
+
+  const float one = 1.f;
+  const float zero = 0.f;
+  float level = 0.f;
+
+  const int attack_steps = (int)lroundf(attack_ms * rate_hz / 1000);
+  for (int i = 0; i < attack_steps; i++)
+    envelope_update(&cfg, &level, &one, 1);
+  double max_err = fabs(level - (1 - exp(-1)));
+
+  level = 1.f;
+  const int release_steps = (int)lroundf(release_ms * rate_hz / 1000);
+  for (int i = 0; i < release_steps; i++)
+    envelope_update(&cfg, &level, &zero, 1);
+  max_err = fmax(max_err, fabs(level - exp(-1)));
+
+  bool ok = max_err <= MAX_ENVELOPE_ERROR;
+  char name[32];
+  snprintf(name, sizeof(name), "env %.0f/%.0f/%.0f", attack_ms, release_ms, rate_hz);
+  printf("%-16s %12.3e %8s\n", name, max_err, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+#define INGEST_SAMPLES  4096
+
+// gain of decimating ingest for tone of given frequency (fraction of
+// input sample rate), both channels carry the same tone
+static double ingest_gain_db(double freq)
+{
+  static int16_t stereo[2*INGEST_SAMPLES];
+  static int16_t mono[INGEST_SAMPLES];
+  const double amp = 16000;
+  for (size_t i = 0; i < INGEST_SAMPLES; i++) {
+    const int16_t v = (int16_t)lround(amp * sin(2 * M_PI * freq * i));
+    stereo[2*i+0] = v;
+    stereo[2*i+1] = v;
+  }
+
+  struct audio_ingest ingest;
+  audio_ingest_init(&ingest, 2);
+  const size_t n = audio_ingest_process(&ingest, stereo, INGEST_SAMPLES, mono);
+
+  // output tone amplitude, correlation skipping filter transient
+  double re = 0, im = 0;
+  size_t count = 0;
+  for (size_t i = AUDIO_INGEST_TAPS; i < n; i++, count++) {
+    re += mono[i] * cos(2 * M_PI * 2 * freq * i);
+    im += mono[i] * sin(2 * M_PI * 2 * freq * i);
+  }
+  const double out = 2 * sqrt(re * re + im * im) / count;
+  return 20 * log10(fmax(out, 1e-3) / amp);
+}
+
+// output must not depend on how input is split into chunks
+static bool check_ingest_chunks(uint8_t decimation)
+{
+  static int16_t whole[MAX_SAMPLES_COUNT];
+  static int16_t chunked[MAX_SAMPLES_COUNT];
+  const size_t ns = MAX_SAMPLES_COUNT;
+
+  struct audio_ingest ingest;
+  audio_ingest_init(&ingest, decimation);
+  const size_t n = audio_ingest_process(&ingest, raw_input, ns, whole);
+
+  audio_ingest_init(&ingest, decimation);
+  size_t out = 0;
+  uint32_t seed = 12345;
+  for (size_t offset = 0; offset < ns; ) {
+    seed = seed * 1664525u + 1013904223u;
+    size_t chunk = 1 + (seed >> 24) % 97;
+    if (chunk > ns - offset)
+      chunk = ns - offset;
+    out += audio_ingest_process(&ingest, raw_input + 2*offset, chunk, chunked + out);
+    offset += chunk;
+  }
+
+  bool ok = out == n && memcmp(whole, chunked, n * sizeof(int16_t)) == 0;
+  char name[32];
+  snprintf(name, sizeof(name), "chunks 1/%u", decimation);
+  printf("%-16s %12s %8s\n", name, "-", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool check_ingest_gain(double freq, bool pass)
+{
+  const double gain = ingest_gain_db(freq);
+  bool ok = pass ? fabs(gain) <= MAX_INGEST_PASS_DB : gain <= MAX_INGEST_STOP_DB;
+  char name[32];
+  snprintf(name, sizeof(name), "%s %.2f fs", pass ? "pass" : "stop", freq);
+  printf("%-16s %12.3f %8s\n", name, gain, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_ingest_check(void)
+{
+  printf("audio ingest vs exact values, gain in dB\n");
+  printf("%-16s %12s %8s\n", "stage", "value", "result");
+
+  bool ok = true;
+  ok &= check_ingest_chunks(1);
+  ok &= check_ingest_chunks(2);
+  static const double pass[] = {0.01, 0.05, 0.1, 0.15};
+  for (size_t i = 0; i < count_of(pass); i++)
+    ok &= check_ingest_gain(pass[i], true);
+  static const double stop[] = {0.35, 0.4, 0.45, 0.49};
+  for (size_t i = 0; i < count_of(stop); i++)
+    ok &= check_ingest_gain(stop[i], false);
+  return ok;
+}
+
+// ----------------------------------------------------------
+
+// bass branch gain, output RMS vs tone RMS, the latest decimated
+// samples are far from filters transient, passband tones must have
+// whole number of periods in them to get exact RMS
+static double multirate_bass_gain_db(double freq)
+{
+  const double amp = 0.5;
+  make_mono_tone(multirate_input, MULTIRATE_SAMPLES, freq, amp);
+
+  struct multirate_bass bass;
+  const size_t ns = count_of(multirate_history);
+  multirate_bass_init(&bass, multirate_history, ns);
+  multirate_bass_push(&bass, multirate_input, MULTIRATE_SAMPLES);
+
+  double sum = 0;
+  for (size_t i = 0; i < ns; i++)
+    sum += (double)multirate_history[i] * multirate_history[i];
+  const double rms = sqrt(sum / ns) / 32767;
+  return 20 * log10(fmax(rms * sqrt(2), 1e-7) / amp);
+}
+
+static bool check_multirate_gain(double freq, bool pass)
+{
+  const double gain = multirate_bass_gain_db(freq);
+  bool ok = pass ? fabs(gain) <= MAX_MULTIRATE_PASS_DB : gain <= MAX_MULTIRATE_STOP_DB;
+  char name[32];
+  snprintf(name, sizeof(name), "%s %.0f Hz", pass ? "pass" : "stop", freq);
+  printf("%-16s %12s %12.3f %8s\n", name, "-", gain, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// analyzes tone by both branches, merged spectrum peak must be at
+// the tone frequency, within bin of spectrum part it belongs to
+static bool check_multirate_tone(unsigned int nfft, double freq)
+{
+  const double amp = 0.5;
+  make_mono_tone(multirate_input, MULTIRATE_SAMPLES, freq, amp);
+
+  // main analysis, the latest block
+  simple_fft_cfg fft_cfg;
+  simple_fft_q15_cfg fft_q15_cfg;
+  struct analysis_cfg acfg;
+  init_analysis(&acfg, &fft_cfg, &fft_q15_cfg, nfft);
+  acfg.mono_input = true;
+  analyze_input(&acfg, multirate_input + MULTIRATE_SAMPLES - 2*nfft, multirate_spectrum);
+
+  // bass analysis of the same input, decimated
+  const size_t bass_rate = BENCH_SAMPLE_RATE / MULTIRATE_DECIMATION;
+  struct multirate_bass bass;
+  multirate_bass_init(&bass, multirate_history, 2*MULTIRATE_BASS_NFFT);
+  multirate_bass_push(&bass, multirate_input, MULTIRATE_SAMPLES);
+
+  simple_fft_cfg bass_fft;
+  struct analysis_cfg bass_acfg;
+  init_bass_analysis(&bass_acfg, &bass_fft, &acfg);
+  analyze_input(&bass_acfg, multirate_history, bass_spectrum);
+
+  struct multirate_layout l;
+  multirate_layout_init(&l, MULTIRATE_CROSSOVER_HZ, bass_rate, MULTIRATE_BASS_NFFT,
+                        BENCH_SAMPLE_RATE, nfft);
+  multirate_merge(&l, bass_spectrum, multirate_spectrum);
+
+  // frequency axis must stay ascending
+  bool ok = true;
+  size_t peak = 0;
+  for (size_t i = 0; i < l.count; i++) {
+    if (i > 0)
+      ok &= multirate_spectrum[2*i] > multirate_spectrum[2*(i-1)];
+    if (multirate_spectrum[2*i+1] > multirate_spectrum[2*peak+1])
+      peak = i;
+  }
+
+  const bool in_bass = peak < l.split;
+  const double bin = in_bass ? (double)bass_rate / (2*MULTIRATE_BASS_NFFT)
+                             : (double)BENCH_SAMPLE_RATE / (2*nfft);
+  const double peak_hz = multirate_spectrum[2*peak];
+  const double err_db = 20 * log10(multirate_spectrum[2*peak+1] / amp);
+  ok &= in_bass == (freq < MULTIRATE_CROSSOVER_HZ);
+  ok &= fabs(peak_hz - freq) <= bin;
+  // bass tones are at bin center, main ones may be anywhere
+  ok &= !in_bass || fabs(err_db) <= MAX_MULTIRATE_PEAK_DB;
+
+  // analyzer bands must be usable with merged spectrum as is
+  struct spectrum_bands bands;
+  multirate_bands_log(&l, &bands, MAX_SPECTRUM_BANDS, 40, 16000);
+  for (uint8_t i = 0; i < bands.count; i++)
+    ok &= bands.edges[i] < bands.edges[i+1] && bands.edges[i+1] <= l.count;
+
+  char name[32];
+  snprintf(name, sizeof(name), "%u %.0f Hz", nfft, freq);
+  printf("%-16s %12.2f %12.3f %8s\n", name, peak_hz, err_db, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// mapped thresholds must cover the same frequencies as original ones,
+// large ones too, merged spectrum has more than 255 elements
+static bool check_multirate_lmh(unsigned int nfft, const uint8_t thr[4])
+{
+  const size_t bass_rate = BENCH_SAMPLE_RATE / MULTIRATE_DECIMATION;
+  struct multirate_layout l;
+  multirate_layout_init(&l, MULTIRATE_CROSSOVER_HZ, bass_rate, MULTIRATE_BASS_NFFT,
+                        BENCH_SAMPLE_RATE, nfft);
+  struct filter_opt opt = f_options;
+  opt.thr_low = thr[0];
+  opt.thr_ml = thr[1];
+  opt.thr_mh = thr[2];
+  opt.thr_high = thr[3];
+  uint16_t bands[6];
+  multirate_lmh_bands(&l, bands, &opt);
+
+  // merged index frequency, the same as multirate_merge() gives
+  #define MERGED_HZ(i) ((i) < l.split ? bass_rate / 2.f * ((i) + 1) / MULTIRATE_BASS_NFFT \
+                                      : BENCH_SAMPLE_RATE / 2.f * ((i) - l.split + l.main_first + 1) / nfft)
+  const float main_bin = BENCH_SAMPLE_RATE / 2.f / nfft;
+
+  // each band edge is within the main bin of its threshold
+  bool ok = bands[0] == 0 && bands[5] == l.count - 1;
+  for (int b = 0; b < 3; b++)
+    ok &= bands[2*b] <= bands[2*b + 1];
+  ok &= bands[1] < bands[2] && bands[3] < bands[4];
+  for (int e = 1; e < 5; e++)
+    ok &= fabsf(MERGED_HZ(bands[e]) - main_bin * (thr[e-1] + 1)) <= main_bin / 2;
+  #undef MERGED_HZ
+
+  char name[32];
+  snprintf(name, sizeof(name), "%u lmh %u", nfft, thr[3]);
+  printf("%-16s %12s %12s %8s\n", name, "-", "-", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_multirate_check(void)
+{
+  printf("multirate analysis, bass decimated by %d, crossover %d Hz\n",
+         MULTIRATE_DECIMATION, MULTIRATE_CROSSOVER_HZ);
+  printf("%-16s %12s %12s %8s\n", "case", "peak, Hz", "error, dB", "result");
+
+  // bass bin width, tones at bin centers have whole number of periods
+  const double bass_bin = (double)BENCH_SAMPLE_RATE / MULTIRATE_DECIMATION / (2*MULTIRATE_BASS_NFFT);
+
+  bool ok = true;
+  static const int pass[] = {4, 10, 28, 100};
+  for (size_t i = 0; i < count_of(pass); i++)
+    ok &= check_multirate_gain(pass[i] * bass_bin, true);
+  static const double stop[] = {4000, 6000, 10000, 16000};
+  for (size_t i = 0; i < count_of(stop); i++)
+    ok &= check_multirate_gain(stop[i], false);
+
+  const double tones[] = {8 * bass_bin, 1000};
+  const uint8_t defaults[4] = {
+    f_options.thr_low, f_options.thr_ml, f_options.thr_mh, f_options.thr_high,
+  };
+  static const uint8_t large[4] = {200, 230, 240, 250};
+  static const unsigned int sizes[] = {256, 512, 1024};
+  for (size_t n = 0; n < count_of(sizes); n++) {
+    for (size_t i = 0; i < count_of(tones); i++)
+      ok &= check_multirate_tone(sizes[n], tones[i]);
+    ok &= check_multirate_lmh(sizes[n], defaults);
+    ok &= check_multirate_lmh(sizes[n], large);
+  }
+  return ok;
+}
+
+// reference stream client, see band_stream.h
+struct stream_decoder {
+  bool valid;     // has the whole frame, deltas can be applied
+  uint8_t seq;
+  struct band_stream_frame frame;
+};
+
+static bool stream_decode(struct stream_decoder* d, const uint8_t* p, size_t len)
+{
+  const uint8_t flags = p[0] & ~BAND_STREAM_DELTA;
+  const size_t n = p[2] + p[3];
+  if (len != BAND_STREAM_HEADER_SIZE + n)
+    return false;
+
+  if (p[0] & BAND_STREAM_DELTA) {
+    // lost packet or different layout, wait for a key one
+    if (!d->valid || p[1] != (uint8_t)(d->seq + 1) || flags != d->frame.flags ||
+        p[2] != d->frame.bands || p[3] != d->frame.points) {
+      d->valid = false;
+      return false;
+    }
+    for (size_t i = 0; i < n; i++)
+      d->frame.values[i] += p[BAND_STREAM_HEADER_SIZE + i];
+  } else {
+    d->frame.flags = flags;
+    d->frame.bands = p[2];
+    d->frame.points = p[3];
+    memcpy(d->frame.values, p + BAND_STREAM_HEADER_SIZE, n);
+  }
+
+  d->seq = p[1];
+  d->valid = true;
+  return true;
+}
+
+// slowly changing levels, silent from time to time, so some
+// frames don't change at all
+static void make_stream_frame(struct band_stream_frame* f, unsigned int k,
+                              uint8_t count, uint8_t npoints, bool db)
+{
+  float bars[3];
+  float levels[MAX_SPECTRUM_BANDS];
+  float points[BAND_STREAM_MAX_POINTS];
+  const bool silence = (k / 100) % 4 == 3;
+  for (int i = 0; i < 3; i++)
+    bars[i] = silence ? 0 : 0.5f + 0.5f * sinf(0.05f * k + i);
+  for (uint8_t i = 0; i < count; i++)
+    levels[i] = silence ? 0 : 0.5f + 0.5f * sinf(0.03f * k + 0.4f * i);
+  for (uint8_t i = 0; i < npoints; i++)
+    points[i] = silence ? 0 : powf(10, -3 + 2.5f * sinf(0.02f * k + 0.2f * i));
+  band_stream_frame_init(f, bars, levels, count, points, npoints, db);
+}
+
+// client must see the same frame as sender has, but truncated to MTU,
+// except the time after lost packet, but that must be short
+static bool check_stream(uint8_t count, uint8_t npoints, bool db, bool delta,
+                         unsigned int mtu, unsigned int loss_period)
+{
+  struct band_stream_encoder enc;
+  band_stream_encoder_reset(&enc);
+  struct stream_decoder dec = {0};
+
+  const size_t max_size = mtu - 3;
+  const size_t expected = max_size - BAND_STREAM_HEADER_SIZE;
+
+  bool ok = true;
+  size_t bytes = 0;
+  unsigned int packets = 0;
+  unsigned int stale = 0;       // frames in a row client is behind
+  unsigned int max_stale = 0;
+  for (unsigned int k = 0; k < STREAM_FRAMES; k++) {
+    struct band_stream_frame f;
+    make_stream_frame(&f, k, count, npoints, db);
+
+    uint8_t packet[BAND_STREAM_MAX_PACKET];
+    const size_t len = band_stream_encode(&enc, &f, delta, packet, max_size);
+    ok &= len <= max_size;
+    if (len > 0) {
+      bytes += len;
+      packets++;
+      if (loss_period == 0 || packets % loss_period != 0)
+        stream_decode(&dec, packet, len);
+    }
+
+    // values which fit, bands first
+    const size_t nb = f.bands < expected ? f.bands : expected;
+    const size_t np = f.points < expected - nb ? f.points : expected - nb;
+    const bool same = dec.valid && dec.frame.bands == nb &&
+                      dec.frame.points == np && dec.frame.flags == f.flags &&
+                      memcmp(dec.frame.values, f.values, nb) == 0 &&
+                      memcmp(dec.frame.values + nb, f.values + f.bands, np) == 0;
+    stale = same ? 0 : stale + 1;
+    if (stale > max_stale)
+      max_stale = stale;
+  }
+
+  // every packet arrived, client is always up to date, otherwise
+  // it catches up with the next key packet, unless that one is lost too
+  ok &= loss_period ? max_stale <= 2*BAND_STREAM_KEY_INTERVAL : max_stale == 0;
+
+  char name[32];
+  snprintf(name, sizeof(name), "%u+%u %s%s/%u%s", count, npoints, db ? "dB" : "u8",
+           delta ? " delta" : "", mtu, loss_period ? " loss" : "");
+  printf("%-24s %10.1f %8u %8s\n", name, (double)bytes / STREAM_FRAMES,
+         max_stale, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool check_stream_quantize(void)
+{
+  bool ok = band_stream_linear(0) == 0 && band_stream_linear(-1) == 0 &&
+            band_stream_linear(0.5f) == 128 && band_stream_linear(1) == 255 &&
+            band_stream_linear(2) == 255 && band_stream_linear(NAN) == 0;
+  // 0 dB, -20 dB, -100 dB and below, +27.5 dB and above
+  ok &= band_stream_db(1) == 200 && band_stream_db(0.1f) == 160 &&
+        band_stream_db(1e-5f) == 0 && band_stream_db(0) == 0 &&
+        band_stream_db(23.7f) == 255 && band_stream_db(100) == 255;
+
+  printf("%-24s %10s %8s %8s\n", "quantization", "-", "-", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool run_stream_check(void)
+{
+  printf("BLE stream, %u frames, decoded by reference client\n", STREAM_FRAMES);
+  printf("%-24s %10s %8s %8s\n", "case", "bytes/frm", "stale", "result");
+
+  bool ok = check_stream_quantize();
+  ok &= check_stream(0, 0, false, false, STREAM_MTU_SMALL, 0);
+  ok &= check_stream(0, 0, false, true, STREAM_MTU_SMALL, 0);
+  ok &= check_stream(16, 0, false, true, STREAM_MTU_SMALL, 0);
+  ok &= check_stream(16, 32, false, false, STREAM_MTU_LARGE, 0);
+  ok &= check_stream(16, 32, false, true, STREAM_MTU_LARGE, 0);
+  ok &= check_stream(32, 32, true, true, STREAM_MTU_LARGE, 0);
+  ok &= check_stream(16, 32, false, true, STREAM_MTU_LARGE, 7);
+  return ok;
+}
+
+static bool run_color_check(void)
+{
+  printf("output stage vs exact values, colors in 16-bit units\n");
+  printf("%-16s %12s %8s\n", "stage", "max error", "result");
+
+  bool ok = true;
+  static const float gammas[] = {1.0f, 2.2f, 2.8f, 4.0f};
+  for (size_t i = 0; i < count_of(gammas); i++)
+    ok &= check_gamma_lut(gammas[i]);
+  ok &= check_dither(8);
+  ok &= check_dither(10);
+  ok &= check_envelope(10, 150, 100);
+  ok &= check_envelope(20, 500, 200);
+  return ok;
+}
+// ----------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  bool do_bench = argc < 2;
+  bool do_check = argc < 2;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--bench") == 0) {
+      do_bench = true;
+    } else if (strcmp(argv[i], "--check") == 0) {
+      do_check = true;
+    } else {
+      fprintf(stderr, "usage: %s [--bench] [--check]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  bool ok = true;
+
+  if (do_check) {
+    ok &= run_accuracy_check();
+    printf("\n");
+    ok &= run_analysis_check();
+    printf("\n");
+    ok &= run_math_check();
+    printf("\n");
+    ok &= run_ingest_check();
+    printf("\n");
+    ok &= run_multirate_check();
+    printf("\n");
+    ok &= run_color_check();
+    printf("\n");
+    ok &= run_stream_check();
+  }
+
+  if (do_check && do_bench)
+    printf("\n");
+
+  if (do_bench)
+    run_benchmark();
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// compile-time tables instantiation for all the benchmarked sizes,
+// plain C interface to them for dsp_bench.c
+
+#include "fixed_tables.h"
+
+#include "simple_fft_fixed.hpp"
+#include "spectrum_fixed.hpp"
+
+template<unsigned int N>
+static constexpr fixed_fft make_fixed_fft()
+{
+  using fft = simple_fft_fixed<N>;
+  using hann = window_fixed<2*N, WINDOW_HANN>;
+  using bh = window_fixed<2*N, WINDOW_BLACKMAN_HARRIS>;
+  using ft = window_fixed<2*N, WINDOW_FLAT_TOP>;
+  return {
+    &fft::cfg, &fft::cfg_q15, &fft::fft_real_bitrev,
+    {hann::kwnd.data(), bh::kwnd.data(), ft::kwnd.data()},
+    {hann::sum, bh::sum, ft::sum},
+    {hann::sq_sum, bh::sq_sum, ft::sq_sum},
+    {hann::kwnd_q15.data(), bh::kwnd_q15.data(), ft::kwnd_q15.data()},
+    {hann::sum_q15, bh::sum_q15, ft::sum_q15},
+  };
+}
+
+static constexpr fixed_fft fixed_ffts[] = {
+  make_fixed_fft<128>(),
+  make_fixed_fft<256>(),
+  make_fixed_fft<512>(),
+  make_fixed_fft<1024>(),
+  make_fixed_fft<2048>(),
+};
+
+const struct fixed_fft* fixed_fft_get(unsigned int nfft)
+{
+  for (const auto& f : fixed_ffts)
+    if (f.cfg->n == nfft)
+      return &f;
+  return nullptr;
+}
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _FIXED_TABLES_H_
+#define _FIXED_TABLES_H_
+
+#include "simple_fft.h"
+#include "simple_fft_q15.h"
+#include "spectrum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// compile-time generated tables and size-specialized FFT for one
+// FFT size, see simple_fft_fixed.hpp and spectrum_fixed.hpp
+struct fixed_fft {
+  const simple_fft_cfg* cfg;
+  const simple_fft_q15_cfg* cfg_q15;
+  void (*fft_real_bitrev)(const simple_fft_cfg* cfg, float* data);
+  // windows, indexed by enum window_type
+  const float* kwnd[3];
+  float kwnd_sum[3];
+  float kwnd_sq_sum[3];
+  const int16_t* kwnd_q15[3];
+  float kwnd_q15_sum[3];
+};
+
+// returns tables for nfft FFTs, NULL if there are no such ones
+const struct fixed_fft* fixed_fft_get(unsigned int nfft);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIXED_TABLES_H_
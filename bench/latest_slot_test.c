@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// host test for latest value slot used between analysis and BLE stream
+// single thread: empty slot, overwrite, the newest item wins,
+// two threads: producer publishes numbered items as fast as it can,
+// consumer checks that items are never torn, repeated or older
+// than the previous one, and that the last one arrives
+// exit code is non-zero if any check fails
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "latest_slot.h"
+
+#define STRESS_ITEMS      2000000u
+
+// something like stream frame, larger than one machine word,
+// so torn reads would be visible
+struct test_item {
+  uint32_t seq;
+  uint32_t payload[15];
+};
+
+static void make_item(struct test_item* item, uint32_t seq)
+{
+  item->seq = seq;
+  for (int i = 0; i < 15; i++)
+    item->payload[i] = seq * 2654435761u + i;
+}
+
+static bool item_valid(const struct test_item* item)
+{
+  struct test_item ref;
+  make_item(&ref, item->seq);
+  for (int i = 0; i < 15; i++)
+    if (item->payload[i] != ref.payload[i])
+      return false;
+  return true;
+}
+
+static bool report(const char* name, bool ok)
+{
+  printf("%-24s %8s\n", name, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool check_single_thread(void)
+{
+  static struct test_item storage[3];
+  struct latest_slot s;
+  latest_slot_init(&s, storage, sizeof(storage[0]));
+
+  struct test_item item;
+  make_item(&item, 12345);
+  bool ok = !latest_slot_take(&s, &item) && item.seq == 12345;
+
+  uint32_t seq = 0;
+  for (int round = 0; round < 5; round++) {
+    // one item
+    make_item(&item, seq++);
+    latest_slot_publish(&s, &item);
+    ok &= latest_slot_take(&s, &item) && item.seq == seq - 1 && item_valid(&item);
+    ok &= !latest_slot_take(&s, &item);
+
+    // a few items, only the last one is taken
+    for (int i = 0; i < round + 2; i++) {
+      make_item(&item, seq++);
+      latest_slot_publish(&s, &item);
+    }
+    ok &= latest_slot_take(&s, &item) && item.seq == seq - 1 && item_valid(&item);
+    ok &= !latest_slot_take(&s, &item);
+  }
+
+  return ok;
+}
+
+static struct latest_slot stress_slot;
+static struct test_item stress_storage[3];
+static volatile bool producer_done;
+
+static void* producer_proc(void* arg)
+{
+  (void)arg;
+  struct test_item item;
+  for (uint32_t seq = 1; seq <= STRESS_ITEMS; seq++) {
+    make_item(&item, seq);
+    latest_slot_publish(&stress_slot, &item);
+    // let consumer run on the same CPU from time to time
+    if (seq % 64 == 0)
+      sched_yield();
+  }
+  __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static bool check_two_threads(void)
+{
+  latest_slot_init(&stress_slot, stress_storage, sizeof(stress_storage[0]));
+  producer_done = false;
+
+  pthread_t producer;
+  if (pthread_create(&producer, NULL, producer_proc, NULL) != 0)
+    return false;
+
+  bool ok = true;
+  uint32_t last = 0;
+  uint32_t taken = 0;
+  for (;;) {
+    const bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+    struct test_item item;
+    if (latest_slot_take(&stress_slot, &item)) {
+      ok &= item_valid(&item) && item.seq > last;
+      last = item.seq;
+      taken++;
+    } else if (done) {
+      break;
+    } else {
+      sched_yield();
+    }
+  }
+
+  pthread_join(producer, NULL);
+  printf("%u of %u items taken\n", taken, STRESS_ITEMS);
+  return ok && last == STRESS_ITEMS;
+}
+
+int main(void)
+{
+  bool ok = true;
+  ok &= report("single thread", check_single_thread());
+  ok &= report("two threads", check_two_threads());
+  return ok ? 0 : 1;
+}
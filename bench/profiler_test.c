@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// host test for frame path profiler, built with PROFILER_ENABLED=1
+// regardless of PROFILER option: stage times go to the right
+// histogram buckets, only busy time counts for deadline misses,
+// reset clears everything, report fits into any buffer
+// exit code is non-zero if any check fails
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "profiler.h"
+
+#define FRAME_PERIOD_US   1000
+
+static bool report(const char* name, bool ok)
+{
+  printf("%-24s %8s\n", name, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static void add_us(enum profiler_stage stage, uint32_t us)
+{
+  profiler_add(stage, us * profiler_ticks_per_us());
+}
+
+// one analyzed frame with given stage times
+static void frame(uint32_t wait_us, uint32_t prepare_us, uint32_t fft_us)
+{
+  add_us(PROFILER_INGEST_WAIT, wait_us);
+  add_us(PROFILER_PREPARE, prepare_us);
+  add_us(PROFILER_FFT, fft_us);
+  profiler_frame_end(FRAME_PERIOD_US);
+}
+
+static bool check_buckets(void)
+{
+  static const struct {
+    uint32_t us;
+    unsigned bucket;
+  } cases[] = {
+    {0, 0}, {1, 1}, {2, 2}, {3, 2}, {4, 3}, {1000, 10}, {1023, 10},
+    {1024, 11}, {100000, PROFILER_BUCKETS - 1},
+  };
+
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    profiler_reset();
+    add_us(PROFILER_PWM, cases[i].us);
+    profiler_commit(PROFILER_OUTPUT_FIRST, PROFILER_OUTPUT_LAST);
+
+    struct profiler_stage_stats st;
+    profiler_stage_get(PROFILER_PWM, &st);
+    ok &= st.count == 1 && st.hist[cases[i].bucket] == 1 &&
+          st.max_us == cases[i].us;
+  }
+  return ok;
+}
+
+static bool check_stats(void)
+{
+  profiler_reset();
+  // the same chunk-wise prepare, summed per frame
+  add_us(PROFILER_PREPARE, 100);
+  add_us(PROFILER_PREPARE, 200);
+  profiler_frame_end(FRAME_PERIOD_US);
+  frame(0, 500, 0);
+
+  struct profiler_stage_stats st;
+  profiler_stage_get(PROFILER_PREPARE, &st);
+  bool ok = st.count == 2 && st.total_us == 800 && st.max_us == 500;
+  // stages without time are still counted, they are a part of frame
+  profiler_stage_get(PROFILER_BANDS, &st);
+  ok &= st.count == 2 && st.total_us == 0 && st.hist[0] == 2;
+  // output stages are separate
+  profiler_stage_get(PROFILER_RMT, &st);
+  ok &= st.count == 0;
+  return ok;
+}
+
+static bool check_deadline(void)
+{
+  profiler_reset();
+  frame(5000, 300, 300);    // long wait is fine
+  frame(0, 600, 600);       // miss
+  frame(0, 500, 500);       // exactly the period
+  frame(10, 800, 400);      // miss
+
+  struct profiler_frame_stats fs;
+  profiler_frame_get(&fs);
+  return fs.frames == 4 && fs.misses == 2 && fs.max_busy_us == 1200;
+}
+
+static bool check_reset(void)
+{
+  frame(0, 2000, 0);
+  profiler_reset();
+
+  // not applied yet, but already invisible
+  struct profiler_frame_stats fs;
+  struct profiler_stage_stats st;
+  profiler_frame_get(&fs);
+  profiler_stage_get(PROFILER_PREPARE, &st);
+  bool ok = fs.frames == 0 && st.count == 0;
+
+  frame(0, 10, 0);
+  profiler_frame_get(&fs);
+  profiler_stage_get(PROFILER_PREPARE, &st);
+  ok &= fs.frames == 1 && fs.misses == 0 && fs.max_busy_us == 10;
+  ok &= st.count == 1 && st.max_us == 10;
+  return ok;
+}
+
+static bool check_report(void)
+{
+  profiler_reset();
+  frame(0, 1500, 0);
+
+  char full[2048];
+  const size_t len = profiler_report(full, sizeof(full), true);
+  bool ok = len == strlen(full) && strstr(full, "misses 1") != NULL &&
+            strstr(full, "prepare 1 1500 1500\n") != NULL;
+
+  // truncated, but still a string
+  char small[32];
+  memset(small, 'x', sizeof(small));
+  ok &= profiler_report(small, sizeof(small), true) == sizeof(small) - 1;
+  ok &= strlen(small) == sizeof(small) - 1 &&
+        strncmp(small, full, sizeof(small) - 1) == 0;
+  ok &= profiler_report(NULL, 0, false) == 0;
+  return ok;
+}
+
+// time source goes forward at its nominal rate, very rough
+static bool check_clock(void)
+{
+  const struct timespec delay = {0, 2000000};
+  const uint32_t t0 = profiler_ticks();
+  nanosleep(&delay, NULL);
+  const uint32_t us = (profiler_ticks() - t0) / profiler_ticks_per_us();
+  return us >= 2000 && us < 1000000;
+}
+
+int main(void)
+{
+  bool ok = true;
+  ok &= report("histogram buckets", check_buckets());
+  ok &= report("stage stats", check_stats());
+  ok &= report("deadline misses", check_deadline());
+  ok &= report("reset", check_reset());
+  ok &= report("text report", check_report());
+  ok &= report("clock", check_clock());
+  return ok ? 0 : 1;
+}
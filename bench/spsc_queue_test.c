@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// host test for SPSC queue used between analysis and output tasks
+// single thread: empty/full behavior, order, counters wrap around,
+// two threads: producer pushes numbered items as fast as it can,
+// consumer checks that nothing is lost, duplicated or reordered
+// exit code is non-zero if any check fails
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "spsc_queue.h"
+
+#define QUEUE_CAPACITY    4
+#define STRESS_ITEMS      2000000u
+
+// something like output frame, larger than one machine word,
+// so torn reads would be visible
+struct test_item {
+  uint32_t seq;
+  uint32_t payload[15];
+};
+
+static void make_item(struct test_item* item, uint32_t seq)
+{
+  item->seq = seq;
+  for (int i = 0; i < 15; i++)
+    item->payload[i] = seq * 2654435761u + i;
+}
+
+static bool item_valid(const struct test_item* item, uint32_t seq)
+{
+  struct test_item ref;
+  make_item(&ref, seq);
+  if (item->seq != seq)
+    return false;
+  for (int i = 0; i < 15; i++)
+    if (item->payload[i] != ref.payload[i])
+      return false;
+  return true;
+}
+
+static bool report(const char* name, bool ok)
+{
+  printf("%-24s %8s\n", name, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// fills and drains the queue a few times starting from given counter
+static bool check_single_thread(uint32_t start)
+{
+  static struct test_item storage[QUEUE_CAPACITY];
+  struct spsc_queue q;
+  spsc_queue_init(&q, storage, sizeof(storage[0]), QUEUE_CAPACITY);
+  q.head = q.tail = start;
+
+  struct test_item item;
+  bool ok = !spsc_queue_pop(&q, &item) && spsc_queue_size(&q) == 0;
+
+  uint32_t seq = 0;
+  for (int round = 0; round < 3; round++) {
+    for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+      make_item(&item, seq + i);
+      ok &= spsc_queue_push(&q, &item);
+    }
+    make_item(&item, 12345);
+    ok &= !spsc_queue_push(&q, &item);
+    ok &= spsc_queue_size(&q) == QUEUE_CAPACITY;
+
+    for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+      ok &= spsc_queue_pop(&q, &item);
+      ok &= item_valid(&item, seq + i);
+    }
+    ok &= !spsc_queue_pop(&q, &item);
+    seq += QUEUE_CAPACITY;
+  }
+
+  return ok;
+}
+
+static struct spsc_queue stress_queue;
+static struct test_item stress_storage[QUEUE_CAPACITY];
+
+static void* producer_proc(void* arg)
+{
+  (void)arg;
+  struct test_item item;
+  for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++) {
+    make_item(&item, seq);
+    // the other side may be on the same CPU, don't burn its time
+    while (!spsc_queue_push(&stress_queue, &item))
+      sched_yield();
+  }
+  return NULL;
+}
+
+static bool check_two_threads(void)
+{
+  spsc_queue_init(&stress_queue, stress_storage,
+                  sizeof(stress_storage[0]), QUEUE_CAPACITY);
+  // start near counters overflow, so wrap around happens under load
+  stress_queue.head = stress_queue.tail = UINT32_MAX - STRESS_ITEMS / 2;
+
+  pthread_t producer;
+  if (pthread_create(&producer, NULL, producer_proc, NULL) != 0)
+    return false;
+
+  bool ok = true;
+  struct test_item item;
+  for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++) {
+    while (!spsc_queue_pop(&stress_queue, &item))
+      sched_yield();
+    ok &= item_valid(&item, seq);
+  }
+
+  pthread_join(producer, NULL);
+  return ok && spsc_queue_size(&stress_queue) == 0;
+}
+
+int main(void)
+{
+  bool ok = true;
+  ok &= report("single thread", check_single_thread(0));
+  ok &= report("single thread, wrap", check_single_thread(UINT32_MAX - 5));
+  ok &= report("two threads", check_two_threads());
+  return ok ? 0 : 1;
+}
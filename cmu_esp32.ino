@@ -2,30 +2,45 @@
 // SPDX-License-Identifier: MIT
 
 #include <algorithm>
-#include <deque>
+#include <array>
 #include <vector>
 
 #include <Preferences.h>
 
 #include <BLEDevice.h>
+#include <BLE2902.h>
 #include <BLEServer.h>
 
+// use fixed-point (Q15) spectrum analysis instead of float one,
+// it is a bit less precise, but its tables are twice smaller
+#define FIXED_POINT_ANALYSIS  0
+
 extern "C" {
+#include "audio_ingest.h"
+#include "audio_stats.h"
+#include "band_stream.h"
+#include "color_out.h"
 #include "device_options.h"
-#include "fft_hann_1024.h"
-#include "fft_twiddles_512.h"
+#include "envelope.h"
 #include "filter.h"
+#include "latest_slot.h"
+#include "multirate.h"
+#include "profiler.h"
 #include "spectrum.h"
+#include "spsc_queue.h"
 }
 #include "device_options_ble.hpp"
 #include "led_strip_encoder.h"
+#include "simple_fft_fixed.hpp"
 
 #include "esp_bt.h"
 #include "esp_bt_main.h"
 #include "esp_a2dp_api.h"
 #include "esp_gap_bt_api.h"
+#include "esp_timer.h"
 
 #include "driver/rmt_tx.h"
+#include "soc/soc_caps.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/ringbuf.h"
@@ -33,21 +48,62 @@ extern "C" {
 
 #define INDICATOR_LED_PIN                 2
 
-#define SAMPLES_COUNT       1024
-#define FFT_SIZE        (SAMPLES_COUNT/2)
+// the largest analyzed block size (FFT size), all the buffers are
+// allocated for it, available sizes are listed in fft_sizes
+#define MAX_SAMPLES_COUNT   4096
+#define MAX_FFT_SIZE        (MAX_SAMPLES_COUNT/2)
+#define MIN_ANALYSIS_HOP    128
+
+// analyzed frames waiting for output, power of 2, output always shows
+// the latest one, so the queue only has to absorb output jitter
+#define FRAME_QUEUE_CAPACITY  4
+
+// LEDs refresh rate limits, Hz
+#define MIN_OUTPUT_RATE       10
+#define MAX_OUTPUT_RATE       200
+
+// BLE stream pace when nobody is connected, ms, only subscription
+// is checked then, connected stream follows connection interval
+#define STREAM_IDLE_PERIOD_MS 100
+// ATT MTU until client negotiates larger one
+#define BLE_DEFAULT_MTU       23
+
+// A2DP data buffer size, in samples, it doesn't depend on FFT size,
+// analysis consumes data in chunks as it arrives
+#define RAW_AUDIO_SAMPLES   1024
+// A2DP data is down-mixed in chunks of this size, in samples
+#define INGEST_BLOCK_SAMPLES  256
+// ring buffer size, double buffering of mono 16bit samples
+#define RAW_AUDIO_BUFFER_SIZE (2*RAW_AUDIO_SAMPLES*sizeof(int16_t))
 
 #define RGB_PWM_FREQ        75000
 #define RGB_PWM_BITS        10
 
 #define RMT_LED_STRIP_RESOLUTION_HZ 20000000 // 20MHz resolution, 1 tick = 0.05us
+// default strip, see rmt_strips_config for more strips
 #define RMT_LED_STRIP_GPIO_NUM      GPIO_NUM_15
 #define RMT_LED_STRIP_LEDS_COUNT    300
+// frames being prepared or transmitted at the same time
+#define RMT_TX_FRAMES               2
+
+// multirate analysis bass branch FFT size (decimated input), and
+// the lowest frequency full-rate FFT gives, see multirate.h
+#define MULTIRATE_BASS_FFT_SIZE   256
+#define MULTIRATE_CROSSOVER_HZ    300
+
+// how often profiler report is printed to serial, see profiler.h
+#define PROFILER_REPORT_PERIOD_MS 10000
+
+// spectrum analyzer bands are log-spaced in this range, Hz
+#define ANALYZER_MIN_FREQ   40
+#define ANALYZER_MAX_FREQ   16000
 
 #define DEVICE_SERVICE_UUID     "8af2e1aa-6cfa-4cd8-a9f9-54243e04d9c7"
 #define FILTER_SERVICE_UUID     "fc8bd000-4814-4031-bff0-fbca1b99ee44"
 
 /* log tags */
 #define BT_AV_TAG           "BT_AV"
+#define ANALYSIS_TAG        "ANALYSIS"
 /* Application layer causes delay value */
 #define APP_DELAY_VALUE                   50  // 5ms
 
@@ -60,31 +116,138 @@ struct device_opt d_options = {
   .swap_r_b_channels = false,
   .enable_rmt_history = false,
   .gamma_value = 2.8,
+  .analyzer_bands = 0,
+  .output_rate = 100,
+  .attack_ms = 10,
+  .release_ms = 150,
+  .stream_points = 0,
+  .stream_format = BAND_STREAM_DELTA,
 };
 String device_name = "ESP_Speaker_K";
 
 // ----------------------------------------------------------
 //           FFT & spectrum analysis configuration
 // ----------------------------------------------------------
-static const simple_fft_cfg fft_cfg = {
-  .n = FFT_SIZE,
-  .tw = fft_twiddles_512,
-  .tw_mul_re = FFT_TWIDDLE_MUL_512_RE,
-  .tw_mul_im = FFT_TWIDDLE_MUL_512_IM,
+// FFT tables and size-specialized FFT for one of the sizes,
+// tables are generated at compile time and are kept in flash
+struct fft_size_desc {
+#if FIXED_POINT_ANALYSIS
+  const simple_fft_q15_cfg* cfg;
+#else
+  const simple_fft_cfg* cfg;
+  void (*fft_real)(const simple_fft_cfg* cfg, float* data);
+#endif
 };
 
-static float fft_io_buffer[SAMPLES_COUNT];      // 4k
+template<unsigned int N>
+static constexpr fft_size_desc fft_size_of()
+{
+  using fft = simple_fft_fixed<N>;
+#if FIXED_POINT_ANALYSIS
+  return {&fft::cfg_q15};
+#else
+  return {&fft::cfg, &fft::fft_real_bitrev};
+#endif
+}
+
+// available FFT sizes (analyzed block size / 2), ascending
+static constexpr fft_size_desc fft_sizes[] = {
+  fft_size_of<128>(),
+  fft_size_of<256>(),
+  fft_size_of<512>(),
+  fft_size_of<1024>(),
+  fft_size_of<2048>(),
+};
+static_assert(fft_sizes[count_of(fft_sizes) - 1].cfg->n == MAX_FFT_SIZE);
+
+// currently used FFT size, one of the above
+static const fft_size_desc* fft_size = &fft_sizes[0];
+
+// window depends on runtime settings, so it is still generated at runtime
+#if FIXED_POINT_ANALYSIS
+static int16_t fft_window_ks[MAX_SAMPLES_COUNT];  // 8k
+#else
+static float fft_window_ks[MAX_SAMPLES_COUNT];  // 16k
+#endif
+
+// with room for bass spectrum merged in multirate analysis
+static float fft_io_buffer[MAX_SAMPLES_COUNT + 2*MULTIRATE_BASS_FFT_SIZE];  // 18k
 // reuse fft_io_buffer for spectrum: freq - amp pairs
-static float spectrum_frs[FFT_SIZE];            // 2k
-static float log_log_f_ks[FFT_SIZE];            // 2k
+static float spectrum_frs[MAX_FFT_SIZE];        // 8k
+static float spectrum_wks[MAX_FFT_SIZE];        // 8k
+
+// multirate analysis bass branch, the same tables for small FFT
+static constexpr fft_size_desc bass_fft_size = fft_size_of<MULTIRATE_BASS_FFT_SIZE>();
+#if FIXED_POINT_ANALYSIS
+static int16_t bass_window_ks[2*MULTIRATE_BASS_FFT_SIZE];   // 1k
+#else
+static float bass_window_ks[2*MULTIRATE_BASS_FFT_SIZE];     // 2k
+#endif
+static float bass_io_buffer[2*MULTIRATE_BASS_FFT_SIZE];     // 2k
+static float bass_frs[MULTIRATE_BASS_FFT_SIZE];             // 1k
+static float bass_wks[MULTIRATE_BASS_FFT_SIZE];             // 1k
+static int16_t bass_input[2*MULTIRATE_BASS_FFT_SIZE];       // 1k
+
+#if FIXED_POINT_ANALYSIS
+struct analysis_cfg acfg = {
+  .engine = ANALYSIS_ENGINE_Q15,
+  .kwnd_q15 = fft_window_ks,
+  .freq = spectrum_frs,
+  .preamp = 1.0,
+  .weights = spectrum_wks,
+  .mono_input = true,
+};
 
+static struct analysis_cfg bass_acfg = {
+  .engine = ANALYSIS_ENGINE_Q15,
+  .fft_q15_cfg = bass_fft_size.cfg,
+  .kwnd_q15 = bass_window_ks,
+  .freq = bass_frs,
+  .preamp = 1.0,
+  .weights = bass_wks,
+  .mono_input = true,
+};
+#else
 struct analysis_cfg acfg = {
-  .fft_cfg = &fft_cfg,
-  .kwnd = fft_window_ks_1024,
+  .engine = ANALYSIS_ENGINE_FLOAT,
+  .kwnd = fft_window_ks,
   .freq = spectrum_frs,
-  .kwnd_sum = FFT_WINDOW_KS_1024_SUM,
   .preamp = 1.0,
+  .weights = spectrum_wks,
+  .mono_input = true,
+};
+
+static struct analysis_cfg bass_acfg = {
+  .engine = ANALYSIS_ENGINE_FLOAT,
+  .fft_cfg = bass_fft_size.cfg,
+  .kwnd = bass_window_ks,
+  .freq = bass_frs,
+  .preamp = 1.0,
+  .weights = bass_wks,
+  .fft_real_fn = bass_fft_size.fft_real,
+  .mono_input = true,
 };
+#endif
+
+// analyzed block size (real FFT size), one of the fft_sizes
+// (doubled), the closest one is used, larger blocks
+// give better frequency resolution, but higher latency
+uint16_t samples_count = 1024;
+// window function applied to analyzed block, see enum window_type
+uint8_t window_type = WINDOW_HANN;
+
+// samples count between the beginnings of analyzed blocks,
+// samples_count (or more) means no overlap, smaller values give
+// higher update rate and lower latency at the cost of more FFTs
+uint16_t analysis_hop = 1024;
+
+// input sample rate divider, 1 or 2, decimation by 2 halves analysis
+// bandwidth, but doubles frequency resolution for the same FFT size
+uint8_t input_decimation = 1;
+
+// bass region comes from decimated input with its own small FFT,
+// so bass bins are much finer without larger (and slower) main FFT
+bool multirate_analysis = false;
 
 struct filter_opt f_options = {
   .level_low = 0.8,
@@ -94,23 +257,175 @@ struct filter_opt f_options = {
   .thr_ml = 3,
   .thr_mh = 18,
   .thr_high = 19,
+  .band_reduction = BAND_REDUCTION_MAX,
 };
 
-// calculate by-frequency amplification coefficients
-// amp_k - amplification coefficients output buffer, size is n
-// freq - frequencies buffer, size is n
-// n - spectrum elements count
-static void amplification_coefficients(float* amp_k, const float* freq, size_t n)
+// by-frequency amplification curve, see enum weighting_curve
+uint8_t weighting_curve = WEIGHTING_LOG_LOG;
+
+// spectrum analyzer bands, depend on sample rate and FFT size
+static struct spectrum_bands analyzer_bands;
+// BLE stream spectrum points, the same way as analyzer bands
+static struct spectrum_bands stream_bands;
+
+// filterbanks for analyzer and 3-band output, used only with
+// BAND_REDUCTION_FILTERBANK, weights are allocated only then
+static struct spectrum_filterbank analyzer_fb;
+static struct spectrum_filterbank lmh_fb;
+static std::vector<float> analyzer_fb_weights;
+static std::vector<float> lmh_fb_weights;
+
+// multirate analysis state, see multirate_analysis, bass history is
+// filled by analysis task as input arrives, spectra are merged into
+// fft_io_buffer, band tables and thresholds are for merged spectrum
+static bool multirate_active = false;
+static struct multirate_bass bass_branch;
+static struct multirate_layout multirate;
+
+// 3 bands of analyzed (or merged) spectrum, rebuilt from thresholds
+// before each block, see spectrum_lmh_bands()
+static uint16_t lmh_bands[6];
+
+// the last sample rate reported by A2DP
+static size_t audio_sample_rate = 44100;
+
+// A2DP data callback state, down-mixes and decimates input,
+// decimation is changed by analysis task, callback applies it
+// before the next chunk, so the state is owned by callback only
+static struct audio_ingest ingest;
+static volatile uint8_t ingest_decimation = 1;
+// analysis input sample rate, i.e. after decimation
+static size_t analysis_sample_rate = 44100;
+
+// audio path health counters, exposed over BLE, each group is
+// written only by its owner, reset is done by owners on request
+struct a2dp_stats a2dp_stats = {};
+struct analysis_stats analysis_stats = {};
+static volatile bool a2dp_stats_reset_pending = false;
+static volatile bool analysis_stats_reset_pending = false;
+static volatile bool output_stats_reset_pending = false;
+// A2DP stream state, set by audio state events
+static volatile bool a2dp_audio_started = false;
+static volatile bool a2dp_stats_restart_pending = false;
+
+void schedule_audio_stats_reset()
+{
+  a2dp_stats_reset_pending = true;
+  analysis_stats_reset_pending = true;
+  output_stats_reset_pending = true;
+#if PROFILER_ENABLED
+  profiler_reset();
+#endif
+}
+
+// analysis settings may be changed from other tasks (BLE, A2DP),
+// but tables are in use while block is analyzed, so they are
+// rebuilt only by analysis task before the next block
+static volatile bool analysis_init_pending = true;
+
+void schedule_analysis_init()
 {
-  for (size_t i = 0; i < n; i++) {
-    amp_k[i] = log(log(freq[i]));
+  analysis_init_pending = true;
+}
+
+// available FFT size closest to the requested analyzed block size
+static const fft_size_desc* analysis_fft_size(size_t requested)
+{
+  size_t i = 0;
+  while (i + 1 < count_of(fft_sizes) && 2*fft_sizes[i+1].cfg->n <= requested)
+    i++;
+  return &fft_sizes[i];
+}
+
+// bands, n - the same as for spectrum_lmh_out()
+static void filterbanks_init(const uint16_t* bands, size_t n)
+{
+  if (f_options.band_reduction != BAND_REDUCTION_FILTERBANK) {
+    std::vector<float>().swap(analyzer_fb_weights);
+    std::vector<float>().swap(lmh_fb_weights);
+    analyzer_fb = {};
+    lmh_fb = {};
+    return;
   }
+
+  // the first call only counts weights
+  analyzer_fb_weights.resize(spectrum_filterbank_bands(&analyzer_fb, nullptr, &analyzer_bands));
+  spectrum_filterbank_bands(&analyzer_fb, analyzer_fb_weights.data(), &analyzer_bands);
+  lmh_fb_weights.resize(spectrum_filterbank_lmh(&lmh_fb, nullptr, bands, n));
+  spectrum_filterbank_lmh(&lmh_fb, lmh_fb_weights.data(), bands, n);
 }
 
-static void frequencies_data_init(size_t sample_rate)
+// (re)builds all the analysis tables for current settings
+// returns analyzed block size
+static size_t analysis_init()
 {
-  frequencies_data(spectrum_frs, sample_rate, FFT_SIZE);
-  amplification_coefficients(log_log_f_ks, spectrum_frs, FFT_SIZE);
+  const fft_size_desc* fft = analysis_fft_size(samples_count);
+  const size_t nfft = fft->cfg->n;
+  fft_size = fft;
+  const size_t ns = 2 * nfft;
+  const auto wnd = static_cast<enum window_type>(window_type);
+  const uint8_t decimation = input_decimation == 2 ? 2 : 1;
+  const size_t sample_rate = audio_sample_rate / decimation;
+  ingest_decimation = decimation;
+  analysis_sample_rate = sample_rate;
+
+#if FIXED_POINT_ANALYSIS
+  acfg.fft_q15_cfg = fft->cfg;
+  acfg.kwnd_sum = window_data_q15(fft_window_ks, ns, wnd, &acfg.kwnd_sq_sum);
+#else
+  acfg.fft_cfg = fft->cfg;
+  acfg.fft_real_fn = fft->fft_real;
+  acfg.kwnd_sum = window_data(fft_window_ks, ns, wnd, &acfg.kwnd_sq_sum);
+#endif
+
+  const auto curve = static_cast<enum weighting_curve>(weighting_curve);
+  frequencies_data(spectrum_frs, sample_rate, nfft);
+  weighting_data(spectrum_wks, spectrum_frs, nfft, curve);
+
+  const uint8_t bands = std::min<uint8_t>(d_options.analyzer_bands, MAX_SPECTRUM_BANDS);
+  const uint8_t points = std::min<uint8_t>(d_options.stream_points, BAND_STREAM_MAX_POINTS);
+  const float max_freq = std::min<size_t>(ANALYZER_MAX_FREQ, sample_rate / 2);
+
+  const bool was_multirate = multirate_active;
+  multirate_active = multirate_analysis;
+  if (multirate_active) {
+    const size_t bass_nfft = MULTIRATE_BASS_FFT_SIZE;
+    const size_t bass_rate = sample_rate / MULTIRATE_DECIMATION;
+    // bass history is kept when only thresholds or other options
+    // change, restarting it makes bass flicker while they are tuned
+    const bool layout_changed = !was_multirate ||
+                                multirate.bass_rate != bass_rate ||
+                                multirate.main_rate != sample_rate ||
+                                multirate.main_nfft != nfft;
+#if FIXED_POINT_ANALYSIS
+    bass_acfg.kwnd_sum = window_data_q15(bass_window_ks, 2*bass_nfft, wnd, &bass_acfg.kwnd_sq_sum);
+#else
+    bass_acfg.kwnd_sum = window_data(bass_window_ks, 2*bass_nfft, wnd, &bass_acfg.kwnd_sq_sum);
+#endif
+    frequencies_data(bass_frs, bass_rate, bass_nfft);
+    weighting_data(bass_wks, bass_frs, bass_nfft, curve);
+    if (layout_changed)
+      multirate_bass_init(&bass_branch, bass_input, 2*bass_nfft);
+
+    multirate_layout_init(&multirate, MULTIRATE_CROSSOVER_HZ,
+                          bass_rate, bass_nfft, sample_rate, nfft);
+    multirate_bands_log(&multirate, &analyzer_bands, bands, ANALYZER_MIN_FREQ, max_freq);
+    multirate_bands_log(&multirate, &stream_bands, points, ANALYZER_MIN_FREQ, max_freq);
+    multirate_lmh_bands(&multirate, lmh_bands, &f_options);
+    filterbanks_init(lmh_bands, multirate.count);
+  } else {
+    spectrum_bands_log(&analyzer_bands, bands, ANALYZER_MIN_FREQ, max_freq,
+                       sample_rate, nfft);
+    spectrum_bands_log(&stream_bands, points, ANALYZER_MIN_FREQ, max_freq,
+                       sample_rate, nfft);
+    spectrum_lmh_bands(lmh_bands, &f_options, nfft);
+    filterbanks_init(lmh_bands, nfft);
+  }
+
+  ESP_LOGI(ANALYSIS_TAG, "Configured: %u samples at %u Hz, window %u, weighting %u, bands %u, multirate %d",
+           static_cast<unsigned>(ns), static_cast<unsigned>(sample_rate),
+           window_type, weighting_curve, analyzer_bands.count, multirate_active);
+  return ns;
 }
 // ----------------------------------------------------------
 
@@ -125,11 +440,85 @@ struct rgb_data_t {
   uint8_t b;
 };
 
-std::deque<rgb_data_t> rmt_history;
-std::vector<rgb_data_t> rmt_pixels;
+// addressable LED strips, each one has its own RMT channel, all of
+// them start transmission at the same time, so frame time depends only
+// on the longest strip, not on strips count (up to 8 strips)
+// in spectrum analyzer mode strip shows band_part of band_parts equal
+// parts of the bands, e.g. {0, 1} - all bands, {1, 2} - upper half
+struct rmt_strip_config {
+  gpio_num_t gpio;
+  uint16_t leds;
+  uint8_t band_part;
+  uint8_t band_parts;
+};
+
+static constexpr rmt_strip_config rmt_strips_config[] = {
+  {RMT_LED_STRIP_GPIO_NUM, RMT_LED_STRIP_LEDS_COUNT, 0, 1},
+  // e.g. bass half on the first strip, treble half on the second:
+  // {GPIO_NUM_15, 300, 0, 2},
+  // {GPIO_NUM_18, 300, 1, 2},
+};
+
+static constexpr size_t RMT_STRIPS_COUNT = std::size(rmt_strips_config);
+
+static constexpr size_t rmt_max_leds()
+{
+  size_t leds = 0;
+  for (const auto& strip : rmt_strips_config)
+    leds = std::max<size_t>(leds, strip.leds);
+  return leds;
+}
+
+// colors history, circular buffer, the newest color is at head,
+// strip shows LEDs count colors from head wrapping around the end,
+// extra entries are for new colors while previous frames are sent
+static std::array<rgb_data_t, rmt_max_leds() + RMT_TX_FRAMES - 1> rmt_history;
+static size_t rmt_history_head = 0;
+
+// strip split into segments, each one starts with lit part
+struct rmt_segment {
+  uint16_t end;       // the first pixel after the segment
+  uint16_t lit_end;   // the first not lit pixel of the segment
+  rgb_data_t on;      // lit pixels color
+};
+
+struct rmt_segment_map {
+  size_t count;
+  rmt_segment segments[MAX_SPECTRUM_BANDS];
+};
+
+// everything encoders read while frame is transmitted, there is no
+// frame buffer, pixels are produced by encoders from these descriptions
+struct rmt_frame {
+  led_strip_spans_t spans[RMT_STRIPS_COUNT];        // history ring
+  led_strip_pattern_t pattern[RMT_STRIPS_COUNT];    // generated pixels
+  rgb_data_t solid_color;
+  rmt_segment_map segments[RMT_STRIPS_COUNT];
+};
+
+// frames are used in turn, the next one is prepared while previous
+// is transmitted, free frames count is given back by tx done callback
+// when all the strips are done with the frame
+static rmt_frame rmt_frames[RMT_TX_FRAMES];
+static size_t rmt_next_frame = 0;
+static SemaphoreHandle_t rmt_free_frames = nullptr;
+static uint32_t rmt_strip_done_frames[RMT_STRIPS_COUNT];   // ISR only
+static uint32_t rmt_released_frames = 0;                    // ISR only
+
+// frames dropped because strip was still busy with previous ones,
+// written by output task only, exposed over BLE with audio stats
+volatile uint32_t rmt_late_frames = 0;
+
+struct rmt_strip {
+  rmt_channel_handle_t chan;
+  rmt_encoder_handle_t encoder;           // pixels buffer
+  rmt_encoder_handle_t pattern_encoder;   // generated pixels
+};
 
-static rmt_channel_handle_t led_chan = nullptr;
-static rmt_encoder_handle_t led_encoder = nullptr;
+static rmt_strip rmt_strips[RMT_STRIPS_COUNT];
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+static rmt_sync_manager_handle_t rmt_sync = nullptr;
+#endif
 
 // ----------------------------------------------------------
 //                   indicator LED blinking
@@ -217,93 +606,364 @@ static void pwm_rgb_init()
   ledcAttachChannel(17, RGB_PWM_FREQ, RGB_PWM_BITS, 2);
 }
 
-static void pwm_rgb_set(float r, float g, float b)
+static dither_channel pwm_dither[3];
+
+// r, g, b - 16-bit values, dithered down to PWM resolution
+static void pwm_rgb_set(uint16_t r, uint16_t g, uint16_t b)
 {
-  constexpr uint32_t max_value = (1 << RGB_PWM_BITS) - 1;
-  ledcWriteChannel(0, static_cast<uint32_t>(std::lround(r*max_value)));
-  ledcWriteChannel(1, static_cast<uint32_t>(std::lround(g*max_value)));
-  ledcWriteChannel(2, static_cast<uint32_t>(std::lround(b*max_value)));
+  ledcWriteChannel(0, dither_quantize(&pwm_dither[0], r, RGB_PWM_BITS));
+  ledcWriteChannel(1, dither_quantize(&pwm_dither[1], g, RGB_PWM_BITS));
+  ledcWriteChannel(2, dither_quantize(&pwm_dither[2], b, RGB_PWM_BITS));
 }
 
 // ----------------------------------------------------------
 //                        RMT RGB out
 // ----------------------------------------------------------
-static void rmt_rgb_init()
+// frames are transmitted in order by each strip, so they are released
+// in order too, as soon as the slowest strip is done with the frame
+// all the strips share the same interrupt, so calls never overlap
+static bool IRAM_ATTR rmt_tx_done(rmt_channel_handle_t, const rmt_tx_done_event_data_t*, void* ctx)
 {
-  rmt_history.resize(RMT_LED_STRIP_LEDS_COUNT);
-  rmt_pixels.resize(RMT_LED_STRIP_LEDS_COUNT);
+  const size_t strip = reinterpret_cast<size_t>(ctx);
+  rmt_strip_done_frames[strip]++;
+
+  uint32_t done = rmt_strip_done_frames[0];
+  for (size_t i = 1; i < RMT_STRIPS_COUNT; i++)
+    if (static_cast<int32_t>(rmt_strip_done_frames[i] - done) < 0)
+      done = rmt_strip_done_frames[i];
+
+  BaseType_t task_woken = pdFALSE;
+  for (; rmt_released_frames != done; rmt_released_frames++)
+    xSemaphoreGiveFromISR(rmt_free_frames, &task_woken);
+  return task_woken == pdTRUE;
+}
 
-  rmt_tx_channel_config_t tx_chan_config = {
-    .gpio_num = RMT_LED_STRIP_GPIO_NUM,
-    .clk_src = RMT_CLK_SRC_DEFAULT, // select source clock
-    .resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ,
-    .mem_block_symbols = 64, // increase the block size can make the LED less flickering
-    .trans_queue_depth = 2,  // set the number of transactions that can be pending in the background
-  };
-  ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &led_chan));
+static void rmt_rgb_init()
+{
+  rmt_free_frames = xSemaphoreCreateCounting(RMT_TX_FRAMES, RMT_TX_FRAMES);
 
   led_strip_encoder_config_t encoder_config = {
     .resolution = RMT_LED_STRIP_RESOLUTION_HZ,
   };
-  ESP_ERROR_CHECK(rmt_new_led_strip_encoder(&encoder_config, &led_encoder));
+  const rmt_tx_event_callbacks_t callbacks = {
+    .on_trans_done = rmt_tx_done,
+  };
+
+  rmt_channel_handle_t channels[RMT_STRIPS_COUNT];
+  for (size_t i = 0; i < RMT_STRIPS_COUNT; i++) {
+    rmt_strip& strip = rmt_strips[i];
+
+    rmt_tx_channel_config_t tx_chan_config = {
+      .gpio_num = rmt_strips_config[i].gpio,
+      .clk_src = RMT_CLK_SRC_DEFAULT, // select source clock
+      .resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ,
+      .mem_block_symbols = 64, // increase the block size can make the LED less flickering
+      .trans_queue_depth = RMT_TX_FRAMES,  // set the number of transactions that can be pending in the background
+    };
+    ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &strip.chan));
+
+    // encoders keep encoding state, so each channel needs its own
+    ESP_ERROR_CHECK(rmt_new_led_strip_encoder(&encoder_config, &strip.encoder));
+    ESP_ERROR_CHECK(rmt_new_led_strip_pattern_encoder(&encoder_config, &strip.pattern_encoder));
+
+    ESP_ERROR_CHECK(rmt_tx_register_event_callbacks(strip.chan, &callbacks, reinterpret_cast<void*>(i)));
+    ESP_ERROR_CHECK(rmt_enable(strip.chan));
+    channels[i] = strip.chan;
+  }
+
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+  // channels start only when all of them have the next frame queued
+  if (RMT_STRIPS_COUNT > 1) {
+    const rmt_sync_manager_config_t sync_config = {
+      .tx_channel_array = channels,
+      .array_size = RMT_STRIPS_COUNT,
+    };
+    ESP_ERROR_CHECK(rmt_new_sync_manager(&sync_config, &rmt_sync));
+  }
+#else
+  // no sync manager (classic ESP32), frames are queued to all the
+  // channels back to back, they are still transmitted in parallel
+  (void)channels;
+#endif
+}
 
-  ESP_ERROR_CHECK(rmt_enable(led_chan));
+// returns frame to fill, or nullptr if all of them are still in use
+// wait - how long to wait for the strip, 0 - count frame as late
+static rmt_frame* rmt_frame_begin(TickType_t wait = 0)
+{
+  if (xSemaphoreTake(rmt_free_frames, wait) != pdTRUE) {
+    rmt_late_frames++;
+    return nullptr;
+  }
+  rmt_frame* frame = &rmt_frames[rmt_next_frame];
+  rmt_next_frame = (rmt_next_frame + 1) % RMT_TX_FRAMES;
+  return frame;
 }
 
-static void rmt_rgb_write_pixels()
+// ctx is rgb_data_t, all pixels have this color
+static void IRAM_ATTR rmt_solid_pixels(const void* ctx, size_t, size_t count, uint8_t* grb)
+{
+  const rgb_data_t rgb = *static_cast<const rgb_data_t*>(ctx);
+  auto* out = reinterpret_cast<rgb_data_t*>(grb);
+  for (size_t i = 0; i < count; i++)
+    out[i] = rgb;
+}
+
+// ctx is rmt_segment_map
+static void IRAM_ATTR rmt_segment_pixels(const void* ctx, size_t first, size_t count, uint8_t* grb)
+{
+  const auto* map = static_cast<const rmt_segment_map*>(ctx);
+  auto* out = reinterpret_cast<rgb_data_t*>(grb);
+  size_t s = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t p = first + i;
+    while (s < map->count && p >= map->segments[s].end)
+      s++;
+    if (s < map->count && p < map->segments[s].lit_end)
+      out[i] = map->segments[s].on;
+    else
+      out[i] = rgb_data_t{0, 0, 0};
+  }
+}
+
+// queues frame for transmission on one strip and returns immediately,
+// frame must not be touched until rmt_frame_begin() gives it again
+static void rmt_rgb_transmit(rmt_channel_handle_t chan, rmt_encoder_handle_t encoder,
+                             const void* payload, size_t size)
 {
   const rmt_transmit_config_t tx_config = {
     .loop_count = 0, // no transfer loop
   };
-  const auto data = rmt_pixels.data();
-  const auto size = rmt_pixels.size() * sizeof(rgb_data_t);
-  ESP_ERROR_CHECK(rmt_transmit(led_chan, led_encoder, data, size, &tx_config));
-  ESP_ERROR_CHECK(rmt_tx_wait_all_done(led_chan, 12));
+  ESP_ERROR_CHECK(rmt_transmit(chan, encoder, payload, size, &tx_config));
 }
 
-static void rmt_rgb_set(float r, float g, float b)
+// sends history from head wrapping around the end to all the strips,
+// encoder takes it as two spans, so nothing is copied
+static void rmt_rgb_write_history(rmt_frame* frame)
 {
-  rgb_data_t rgb;
-  rgb.r = static_cast<uint8_t>(std::lround(r*255));
-  rgb.g = static_cast<uint8_t>(std::lround(g*255));
-  rgb.b = static_cast<uint8_t>(std::lround(b*255));
+  for (size_t i = 0; i < RMT_STRIPS_COUNT; i++) {
+    const size_t count = rmt_strips_config[i].leds;
+    const size_t first_count = std::min(count, rmt_history.size() - rmt_history_head);
+    frame->spans[i] = {
+      .first = rmt_history.data() + rmt_history_head,
+      .first_size = first_count * sizeof(rgb_data_t),
+      .second = rmt_history.data(),
+      .second_size = (count - first_count) * sizeof(rgb_data_t),
+    };
+    rmt_rgb_transmit(rmt_strips[i].chan, rmt_strips[i].encoder, &frame->spans[i], sizeof(frame->spans[i]));
+  }
+}
+
+// sends pixels generated by callback to the strip, see led_strip_pixels_cb_t,
+// it is called from RMT interrupt, so integer only code there
+static void rmt_rgb_write_pattern(rmt_frame* frame, size_t strip,
+                                  led_strip_pixels_cb_t pixels, const void* ctx)
+{
+  frame->pattern[strip] = {
+    .pixels = pixels,
+    .ctx = ctx,
+    .count = rmt_strips_config[strip].leds,
+  };
+  rmt_rgb_transmit(rmt_strips[strip].chan, rmt_strips[strip].pattern_encoder,
+                   &frame->pattern[strip], sizeof(frame->pattern[strip]));
+}
 
-  rmt_history.pop_back();
-  rmt_history.push_front(rgb);
+// all the strips are filled with the same color
+static void rmt_rgb_write_solid(rmt_frame* frame, rgb_data_t rgb)
+{
+  frame->solid_color = rgb;
+  for (size_t i = 0; i < RMT_STRIPS_COUNT; i++)
+    rmt_rgb_write_pattern(frame, i, rmt_solid_pixels, &frame->solid_color);
+}
 
-  if (d_options.enable_rmt_history) {
-    std::copy(rmt_history.begin(), rmt_history.end(), rmt_pixels.begin());
-  } else {
-    std::fill(rmt_pixels.begin(), rmt_pixels.end(), rgb);
+static dither_channel rmt_dither[3];
+
+// r, g, b - 16-bit values, new color is dithered down to 8 bits
+static void rmt_rgb_set(uint16_t r, uint16_t g, uint16_t b)
+{
+  // strip is busy, skip the frame, the next one is fresher anyway
+  rmt_frame* frame = rmt_frame_begin();
+  if (!frame)
+    return;
+
+  rgb_data_t rgb;
+  rgb.r = static_cast<uint8_t>(dither_quantize(&rmt_dither[0], r, 8));
+  rgb.g = static_cast<uint8_t>(dither_quantize(&rmt_dither[1], g, 8));
+  rgb.b = static_cast<uint8_t>(dither_quantize(&rmt_dither[2], b, 8));
+
+  // the oldest color is replaced with the new one, which becomes head,
+  // it is not shown by the frames which may be still transmitted
+  rmt_history_head = (rmt_history_head + rmt_history.size() - 1) % rmt_history.size();
+  rmt_history[rmt_history_head] = rgb;
+
+  if (d_options.enable_rmt_history)
+    rmt_rgb_write_history(frame);
+  else
+    rmt_rgb_write_solid(frame, rgb);
+}
+
+// spectrum analyzer: each strip shows its part of the bands, strip is
+// split into equal segments, one per band, each segment is lit
+// proportionally to the band level, colors go from red (bass)
+// through green to blue (treble) across all the strips
+static void rmt_bands_segments(rmt_segment_map* map, const rmt_strip_config& strip,
+                               const float* levels, size_t n)
+{
+  const size_t leds = strip.leds;
+  const size_t first = strip.band_part * n / strip.band_parts;
+  const size_t last = (strip.band_part + 1) * n / strip.band_parts;
+  const size_t count = last - first;
+
+  map->count = count;
+  for (size_t k = 0; k < count; k++) {
+    const size_t i = first + k;
+    const size_t b = k * leds / count;
+    const size_t e = (k + 1) * leds / count;
+    const size_t lit = std::lround(std::clamp(levels[i], 0.f, 1.f) * (e - b));
+
+    const float t = n > 1 ? static_cast<float>(i) / (n - 1) : 0.f;
+    float r = std::max(0.f, 1 - 2*t);
+    float g = 1 - std::fabs(2*t - 1);
+    float bl = std::max(0.f, 2*t - 1);
+    if (d_options.swap_r_b_channels)
+      std::swap(r, bl);
+
+    rgb_data_t on;
+    on.r = static_cast<uint8_t>(std::lround(r*255));
+    on.g = static_cast<uint8_t>(std::lround(g*255));
+    on.b = static_cast<uint8_t>(std::lround(bl*255));
+
+    map->segments[k] = {
+      .end = static_cast<uint16_t>(e),
+      .lit_end = static_cast<uint16_t>(b + lit),
+      .on = on,
+    };
   }
+}
+
+static void rmt_bands_set(const float* levels, size_t n)
+{
+  rmt_frame* frame = rmt_frame_begin();
+  if (!frame)
+    return;
 
-  rmt_rgb_write_pixels();
+  for (size_t i = 0; i < RMT_STRIPS_COUNT; i++) {
+    rmt_bands_segments(&frame->segments[i], rmt_strips_config[i], levels, n);
+    rmt_rgb_write_pattern(frame, i, rmt_segment_pixels, &frame->segments[i]);
+  }
 }
 
 static void rmt_rgb_clear()
 {
   constexpr const rgb_data_t rgb{0, 0, 0};
+  // clear must not be lost, it is rare, so just wait for the strip
+  rmt_frame* frame = rmt_frame_begin(portMAX_DELAY);
   std::fill(rmt_history.begin(), rmt_history.end(), rgb);
-  std::fill(rmt_pixels.begin(), rmt_pixels.end(), rgb);
-  rmt_rgb_write_pixels();
+  rmt_rgb_write_solid(frame, rgb);
 }
 // ----------------------------------------------------------
-static void spectrum_rgb_out(const float* spectrum)
+//                analysis -> output pipeline
+// ----------------------------------------------------------
+// analysis and output run in their own tasks pinned to different
+// cores, so the next block is analyzed while LEDs are updated,
+// they are connected by lock-free queue of analyzed frames
+// output refreshes LEDs at fixed rate, independent from analysis rate,
+// levels follow the latest analyzed frame with attack/release envelopes
+
+// everything output needs to show one analyzed block
+struct band_frame {
+  float bars[3];                      // 3-band levels
+  uint8_t count;                      // analyzer bands count, 0 - off
+  float levels[MAX_SPECTRUM_BANDS];   // analyzer bands levels
+};
+
+static band_frame frame_queue_items[FRAME_QUEUE_CAPACITY];
+static struct spsc_queue frame_queue;
+
+static TaskHandle_t analysis_task = nullptr;
+static TaskHandle_t output_task = nullptr;
+static TaskHandle_t stream_task = nullptr;
+
+// BLE stream of live levels, analysis publishes quantized frames only
+// while somebody is subscribed, stream task sends the latest one
+static band_stream_frame stream_slot_items[3];
+static struct latest_slot stream_slot;
+static volatile bool stream_active = false;
+static BLECharacteristic* stream_characteristic = nullptr;
+
+// current BLE connection, set by BLE callbacks, used by stream task
+static volatile bool ble_connected = false;
+static volatile uint16_t ble_conn_interval_ms = STREAM_IDLE_PERIOD_MS;
+static volatile uint16_t ble_mtu = BLE_DEFAULT_MTU;
+
+// LEDs are changed only by output task, others ask it to do so
+static volatile bool output_clear_pending = false;
+
+static void schedule_output_clear()
+{
+  output_clear_pending = true;
+}
+
+// analysis side, reduces spectrum to bands levels
+// n - spectrum elements count, see spectrum_lmh_out()
+static void spectrum_frame(const float* spectrum, size_t n, band_frame* frame)
 {
-  float bars[3];
-  spectrum_lmh_out(spectrum, FFT_SIZE, bars, &f_options);
+  // filterbanks are rebuilt before the next block after option change
+  const bool fb_ready = f_options.band_reduction == BAND_REDUCTION_FILTERBANK &&
+                        lmh_fb.weights && analyzer_fb.count == analyzer_bands.count;
 
-  for (int i = 0; i < count_of(bars); i++)
-    bars[i] = std::clamp(bars[i], 0.f, 1.f);
+  spectrum_lmh_out(spectrum, n, frame->bars, lmh_bands, &f_options,
+                   fb_ready ? &lmh_fb : nullptr);
+
+  frame->count = analyzer_bands.count;
+  if (frame->count == 0)
+    return;
 
+  if (fb_ready)
+    spectrum_filterbank_out(spectrum, &analyzer_fb, frame->levels);
+  else
+    spectrum_bands_out(spectrum, &analyzer_bands, frame->levels);
+}
+
+// analysis side, quantizes frame and spectrum points for BLE stream
+static void stream_publish(const float* spectrum, const band_frame& frame)
+{
+  float points[BAND_STREAM_MAX_POINTS];
+  spectrum_bands_out(spectrum, &stream_bands, points);
+
+  band_stream_frame f;
+  band_stream_frame_init(&f, frame.bars, frame.levels, frame.count,
+                         points, stream_bands.count,
+                         d_options.stream_format & BAND_STREAM_BANDS_DB);
+  // never waits, sender takes only the latest one anyway
+  latest_slot_publish(&stream_slot, &f);
+}
+
+// output side, shows frame on PWM and RMT outputs
+// gamma correction table, rebuilt by output task when option changes
+static gamma_lut output_gamma;
+
+static void frame_rgb_out(const band_frame& frame)
+{
+  if (output_gamma.gamma != d_options.gamma_value)
+    gamma_lut_init(&output_gamma, d_options.gamma_value);
+
+  uint16_t bars[3];
   for (int i = 0; i < count_of(bars); i++)
-    bars[i] = std::pow(bars[i], d_options.gamma_value);
+    bars[i] = gamma_lut_apply(&output_gamma, frame.bars[i]);
 
   if (d_options.swap_r_b_channels)
     std::swap(bars[0], bars[2]);
 
+  PROFILER_START(t);
   pwm_rgb_set(bars[0], bars[1], bars[2]);
-  rmt_rgb_set(bars[0], bars[1], bars[2]);
+  PROFILER_LAP(t, PROFILER_PWM);
+
+  if (frame.count > 0)
+    rmt_bands_set(frame.levels, frame.count);
+  else
+    rmt_rgb_set(bars[0], bars[1], bars[2]);
+  PROFILER_LAP(t, PROFILER_RMT);
 }
 // ----------------------------------------------------------
 
@@ -356,20 +1016,27 @@ static void handle_a2d_connection_state(const esp_a2d_cb_param_t* param)
 {
   switch (param->conn_stat.state) {
     case ESP_A2D_CONNECTION_STATE_DISCONNECTED:
+      a2dp_audio_started = false;
       esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
       stop_led_blinking();
-      pwm_rgb_set(0, 0, 0);
-      rmt_rgb_clear();
+      schedule_output_clear();
       break;
     case ESP_A2D_CONNECTION_STATE_CONNECTED:
       esp_bt_gap_set_scan_mode(ESP_BT_NON_CONNECTABLE, ESP_BT_NON_DISCOVERABLE);
       start_led_blinking();
       maybe_save_bt_peer_addr(param->conn_stat.remote_bda);
-      rmt_rgb_clear();
+      schedule_output_clear();
       break;
   }
 }
 
+static void handle_a2d_audio_state(const esp_a2d_cb_param_t* param)
+{
+  a2dp_audio_started = param->audio_stat.state == ESP_A2D_AUDIO_STATE_STARTED;
+  // stats are written by data callback only, it restarts interval
+  a2dp_stats_restart_pending = true;
+}
+
 static void handle_a2d_audio_cfg(const esp_a2d_cb_param_t* param)
 {
   const esp_a2d_mcc_t* p_mcc = &param->audio_cfg.mcc;
@@ -400,7 +1067,8 @@ static void handle_a2d_audio_cfg(const esp_a2d_cb_param_t* param)
              p_mcc->cie.sbc_info.max_bitpool);
     ESP_LOGI(BT_AV_TAG, "Audio player configured, sample rate: %d", sample_rate);
 
-    frequencies_data_init(sample_rate);
+    audio_sample_rate = sample_rate;
+    schedule_analysis_init();
   }
 }
 
@@ -417,6 +1085,7 @@ static void bt_app_a2d_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t* param)
     /* when audio stream transmission state changed, this event comes */
     case ESP_A2D_AUDIO_STATE_EVT:
       ESP_LOGI(BT_AV_TAG, "ESP_A2D_AUDIO_STATE_EVT: %d", param->audio_stat.state);
+      handle_a2d_audio_state(param);
       break;
     /* when audio codec is configured, this event comes */
     case ESP_A2D_AUDIO_CFG_EVT:
@@ -465,10 +1134,43 @@ static void bt_app_a2d_cb(esp_a2d_cb_event_t event, esp_a2d_cb_param_t* param)
   }
 }
 
+// only mono (and maybe decimated) samples enter the ring buffer,
+// analysis sums channels anyway
 static void bt_app_a2d_data_cb(const uint8_t* data, uint32_t len)
 {
+  static int16_t mono[INGEST_BLOCK_SAMPLES];
+
+  if (ingest.decimation != ingest_decimation)
+    audio_ingest_init(&ingest, ingest_decimation);
+
+  if (a2dp_stats_reset_pending) {
+    a2dp_stats_reset_pending = false;
+    a2dp_stats_reset(&a2dp_stats);
+  }
+  if (a2dp_stats_restart_pending) {
+    a2dp_stats_restart_pending = false;
+    a2dp_stats_restart(&a2dp_stats);
+  }
+  a2dp_stats_packet(&a2dp_stats, len, esp_timer_get_time());
+
+  const int16_t* stereo = reinterpret_cast<const int16_t*>(data);
+  size_t ns = len / (2 * sizeof(int16_t));
   BaseType_t high_prio_task_woken = pdFALSE;
-  xRingbufferSendFromISR(raw_audio_buffer, data, len, &high_prio_task_woken);
+  uint32_t dropped = 0;
+
+  while (ns > 0) {
+    const size_t n = std::min<size_t>(ns, INGEST_BLOCK_SAMPLES);
+    const size_t out = audio_ingest_process(&ingest, stereo, n, mono);
+    const size_t bytes = out * sizeof(int16_t);
+    // analysis is behind, this chunk is lost
+    if (bytes > 0 && xRingbufferSendFromISR(raw_audio_buffer, mono, bytes, &high_prio_task_woken) != pdTRUE)
+      dropped += bytes;
+    stereo += 2 * n;
+    ns -= n;
+  }
+
+  a2dp_stats_ring(&a2dp_stats, dropped,
+                  RAW_AUDIO_BUFFER_SIZE - xRingbufferGetCurFreeSize(raw_audio_buffer));
 }
 // ----------------------------------------------------------
 
@@ -517,30 +1219,55 @@ static void reconnect_to_last_device()
   }
 }
 
+// connection interval is in 1.25 ms units
+static uint16_t conn_interval_to_ms(uint16_t interval)
+{
+  return (interval * 5 + 3) / 4;
+}
+
 class MyServerCallbacks: public BLEServerCallbacks
 {
-  void onConnect(BLEServer* pServer)
+  void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param)
   {
+    ble_conn_interval_ms = conn_interval_to_ms(param->connect.conn_params.interval);
+    ble_mtu = BLE_DEFAULT_MTU;
+    ble_connected = true;
   }
 
   void onDisconnect(BLEServer* pServer)
   {
+    ble_connected = false;
+    ble_conn_interval_ms = STREAM_IDLE_PERIOD_MS;
     // pServer->startAdvertising();
     BLEDevice::startAdvertising();
   }
+
+  void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param)
+  {
+    ble_mtu = param->mtu.mtu;
+  }
 };
 
+// client may ask for other connection parameters at any time
+static void ble_gap_event(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param)
+{
+  if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT && param->update_conn_params.status == ESP_BT_STATUS_SUCCESS)
+    ble_conn_interval_ms = conn_interval_to_ms(param->update_conn_params.conn_int);
+}
+
 static void ble_server_init(const char* dev_name)
 {
   BLEDevice::init(dev_name);
   BLEServer* pServer = BLEDevice::createServer();
   pServer->setCallbacks(new MyServerCallbacks);
+  BLEDevice::setCustomGapHandler(ble_gap_event);
 
-  auto d_service = pServer->createService(BLEUUID(DEVICE_SERVICE_UUID), 32);
+  auto d_service = pServer->createService(BLEUUID(DEVICE_SERVICE_UUID), 128);
   ble_add_device_characteristics(d_service);
+  stream_characteristic = ble_add_stream_characteristic(d_service);
   d_service->start();
 
-  auto f_service = pServer->createService(BLEUUID(FILTER_SERVICE_UUID), 64);
+  auto f_service = pServer->createService(BLEUUID(FILTER_SERVICE_UUID), 96);
   ble_add_filter_characteristics(f_service);
   f_service->start();
 
@@ -557,6 +1284,10 @@ static void ble_server_init(const char* dev_name)
 // ----------------------------------------------------------
 //                       Arduino hooks
 // ----------------------------------------------------------
+static void analysis_task_proc(void*);
+static void output_task_proc(void*);
+static void stream_task_proc(void*);
+
 void setup()
 {
   Serial.begin(115200);
@@ -564,8 +1295,8 @@ void setup()
   delay(500);
   Serial.println("serial ready!");
 
-  // use double buffering: 2 buffers x 2 16bit channels
-  raw_audio_buffer = xRingbufferCreate(2*2*SAMPLES_COUNT*sizeof(int16_t), RINGBUF_TYPE_BYTEBUF);
+  audio_ingest_init(&ingest, ingest_decimation);
+  raw_audio_buffer = xRingbufferCreate(RAW_AUDIO_BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF);
 
   pwm_rgb_init();
   rmt_rgb_init();
@@ -575,34 +1306,281 @@ void setup()
 
   load_values_from_config();
 
+  // analysis on app core together with Arduino, output on protocol
+  // core, it is short and must not be delayed by long FFT
+  spsc_queue_init(&frame_queue, frame_queue_items, sizeof(frame_queue_items[0]), FRAME_QUEUE_CAPACITY);
+  latest_slot_init(&stream_slot, stream_slot_items, sizeof(stream_slot_items[0]));
+  xTaskCreatePinnedToCore(output_task_proc, "output", 4096, nullptr, 3, &output_task, 0);
+  xTaskCreatePinnedToCore(analysis_task_proc, "analysis", 8192, nullptr, 2, &analysis_task, 1);
+
   bt_audio_sink_init(device_name.c_str());
   ble_server_init(device_name.c_str());
+  // the least important one, notifications only
+  xTaskCreatePinnedToCore(stream_task_proc, "stream", 4096, nullptr, 1, &stream_task, 0);
   reconnect_to_last_device();
 }
 
-static int16_t input_buffer[2*SAMPLES_COUNT];   // 2 channels
+// analysis history, the last analyzed block samples
+static int16_t input_buffer[MAX_SAMPLES_COUNT];   // mono, 8k
 
-void loop()
+// reads the whole block of new samples and analyzes it,
+// each chunk is processed right in the ring buffer memory
+// as soon as it arrives, so no copying is involved and FFT
+// starts immediately after the last chunk is received
+// ns - analyzed block size
+static void analyze_next_block(size_t ns)
+{
+  size_t offset = 0;
+
+  while (offset < ns) {
+    size_t bytes_read = 0;
+    size_t bytes_left = (ns - offset) * sizeof(int16_t);
+    PROFILER_START(t);
+    void* buffer = xRingbufferReceiveUpTo(raw_audio_buffer, &bytes_read, pdMS_TO_TICKS(10), bytes_left);
+    PROFILER_LAP(t, PROFILER_INGEST_WAIT);
+    if (buffer && bytes_read > 0) {
+      // ingest always sends whole samples
+      const size_t n = bytes_read / sizeof(int16_t);
+      // bass decimation is timed here, after waiting for audio,
+      // prepare_input_chunk() times itself
+      if (multirate_active) {
+        multirate_bass_push(&bass_branch, static_cast<const int16_t*>(buffer), n);
+        PROFILER_LAP(t, PROFILER_PREPARE);
+      }
+      prepare_input_chunk(&acfg, offset, static_cast<const int16_t*>(buffer), n, fft_io_buffer);
+      offset += n;
+      vRingbufferReturnItem(raw_audio_buffer, buffer);
+    } else if (!buffer && a2dp_audio_started) {
+      // no audio while nothing is playing is not a stall
+      analysis_stats.timeouts++;
+    }
+  }
+
+  analyze_prepared_input(&acfg, fft_io_buffer);
+}
+
+// reads hop new samples into analysis history and analyzes it
+// blocks overlap, so input can't be processed as it arrives
+// ns - analyzed block size, history size
+static void analyze_next_hop(size_t hop, size_t ns)
 {
-  size_t bytes_left = sizeof(input_buffer);
-  size_t dst_offset = 0;
+  // keep the last (ns - hop) samples, read hop new ones after them
+  const size_t history_bytes = ns * sizeof(int16_t);
+  const size_t keep_bytes = (ns - hop) * sizeof(int16_t);
+  memmove(input_buffer, (uint8_t*)input_buffer + history_bytes - keep_bytes, keep_bytes);
+
+  size_t bytes_left = history_bytes - keep_bytes;
+  size_t dst_offset = keep_bytes;
 
   while (bytes_left > 0) {
     size_t bytes_read = 0;
+    PROFILER_START(t);
     void* buffer = xRingbufferReceiveUpTo(raw_audio_buffer, &bytes_read, pdMS_TO_TICKS(10), bytes_left);
+    PROFILER_LAP(t, PROFILER_INGEST_WAIT);
     if (buffer && bytes_read > 0) {
       bytes_left -= bytes_read;
       memcpy((uint8_t*)input_buffer + dst_offset, buffer, bytes_read);
+      if (multirate_active)
+        multirate_bass_push(&bass_branch, static_cast<const int16_t*>(buffer),
+                            bytes_read / sizeof(int16_t));
+      // copy and bass decimation, after waiting for audio
+      PROFILER_LAP(t, PROFILER_PREPARE);
       dst_offset += bytes_read;
       vRingbufferReturnItem(raw_audio_buffer, buffer);
+    } else if (!buffer && a2dp_audio_started) {
+      // no audio while nothing is playing is not a stall
+      analysis_stats.timeouts++;
     }
   }
 
   analyze_input(&acfg, input_buffer, fft_io_buffer);
+}
 
-  for (int i = 0; i < FFT_SIZE; i++) {
-    fft_io_buffer[2*i + 1] *= 2 * log_log_f_ks[i];
+// analysis task, runs the whole DSP pipeline block after block
+// and passes results to output task, never waits for the output
+static void analysis_task_proc(void*)
+{
+  size_t ns = MAX_SAMPLES_COUNT;
+
+  for (;;) {
+    if (analysis_init_pending) {
+      analysis_init_pending = false;
+      const size_t new_ns = analysis_init();
+      // history has different size, start it from silence
+      if (new_ns != ns)
+        memset(input_buffer, 0, sizeof(input_buffer));
+      ns = new_ns;
+    }
+
+    if (analysis_stats_reset_pending) {
+      analysis_stats_reset_pending = false;
+      analysis_stats_reset(&analysis_stats);
+    }
+
+    const size_t hop = std::clamp<size_t>(analysis_hop, MIN_ANALYSIS_HOP, ns);
+    if (multirate_active) {
+      // thresholds may be changed at any time, bands follow them
+      multirate_lmh_bands(&multirate, lmh_bands, &f_options);
+#if !FIXED_POINT_ANALYSIS
+      // bass comes from its own FFT, pruned engine has nothing to save
+      acfg.engine = ANALYSIS_ENGINE_FLOAT;
+#endif
+    } else {
+      // thresholds may be changed at any time, compute only what they need
+      spectrum_lmh_bands(lmh_bands, &f_options, fft_size->cfg->n);
+      spectrum_lmh_setup(&acfg, &f_options);
+      spectrum_bands_setup(&acfg, &analyzer_bands);
+      if (stream_active)
+        spectrum_bands_setup(&acfg, &stream_bands);
+    }
+
+    if (hop == ns)
+      analyze_next_block(ns);
+    else
+      analyze_next_hop(hop, ns);
+
+    band_frame frame{};
+    if (multirate_active) {
+      // bass history is always up to date, it is small FFT anyway
+      bass_acfg.preamp = acfg.preamp;
+      analyze_input(&bass_acfg, bass_input, bass_io_buffer);
+    }
+
+    PROFILER_START(t);
+    if (multirate_active) {
+      multirate_merge(&multirate, bass_io_buffer, fft_io_buffer);
+      spectrum_frame(fft_io_buffer, multirate.count, &frame);
+    } else {
+      spectrum_frame(fft_io_buffer, fft_size->cfg->n, &frame);
+    }
+    PROFILER_LAP(t, PROFILER_BANDS);
+    // hop new samples per frame, analysis must keep up with them
+    PROFILER_FRAME_END(static_cast<uint32_t>(uint64_t(hop) * 1000000 / analysis_sample_rate));
+    analysis_stats.frames++;
+    if (stream_active)
+      stream_publish(fft_io_buffer, frame);
+    // output is behind, drop this frame, the next one is fresher anyway
+    spsc_queue_push(&frame_queue, &frame);
+  }
+}
+
+// output task, refreshes LEDs at fixed rate, levels move towards the
+// latest analyzed frame, older ones still waiting in the queue are skipped
+static void output_task_proc(void*)
+{
+  band_frame target = {};   // the latest analyzed frame
+  band_frame shown = {};    // what is on LEDs now
+  bool active = false;      // nothing to show until the first frame
+
+  envelope_cfg envelope;
+  uint8_t envelope_rate = 0;
+  uint16_t envelope_attack = 0;
+  uint16_t envelope_release = 0;
+
+  TickType_t last_wake = xTaskGetTickCount();
+
+  for (;;) {
+    const uint8_t rate = std::clamp<uint8_t>(d_options.output_rate, MIN_OUTPUT_RATE, MAX_OUTPUT_RATE);
+    vTaskDelayUntil(&last_wake, std::max<TickType_t>(pdMS_TO_TICKS(1000 / rate), 1));
+
+    if (output_stats_reset_pending) {
+      output_stats_reset_pending = false;
+      rmt_late_frames = 0;
+    }
+
+    if (output_clear_pending) {
+      output_clear_pending = false;
+      active = false;
+      target = {};
+      shown = {};
+      pwm_rgb_set(0, 0, 0);
+      rmt_rgb_clear();
+    }
+
+    band_frame frame;
+    while (spsc_queue_pop(&frame_queue, &frame)) {
+      target = frame;
+      active = true;
+    }
+
+    if (!active)
+      continue;
+
+    // options may be changed at any time, exp() only when they are
+    if (rate != envelope_rate ||
+        d_options.attack_ms != envelope_attack ||
+        d_options.release_ms != envelope_release) {
+      envelope_rate = rate;
+      envelope_attack = d_options.attack_ms;
+      envelope_release = d_options.release_ms;
+      envelope_init(&envelope, envelope_attack, envelope_release, envelope_rate);
+    }
+
+    envelope_update(&envelope, shown.bars, target.bars, count_of(shown.bars));
+    // bands layout has changed, previous levels mean nothing
+    if (shown.count != target.count) {
+      shown.count = target.count;
+      std::copy(target.levels, target.levels + target.count, shown.levels);
+    }
+    envelope_update(&envelope, shown.levels, target.levels, shown.count);
+
+    frame_rgb_out(shown);
+    PROFILER_OUTPUT_END();
+  }
+}
+
+static bool stream_subscribed()
+{
+  auto cccd = static_cast<BLE2902*>(stream_characteristic->getDescriptorByUUID(BLEUUID(static_cast<uint16_t>(0x2902))));
+  return cccd && cccd->getNotifications();
+}
+
+// BLE stream task, sends the latest analyzed frame once per connection
+// interval, faster notifications would only pile up in BLE stack,
+// analysis publishes frames only while client is subscribed
+static void stream_task_proc(void*)
+{
+  band_stream_encoder encoder;
+  band_stream_encoder_reset(&encoder);
+
+  TickType_t last_wake = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelayUntil(&last_wake, std::max<TickType_t>(pdMS_TO_TICKS(ble_conn_interval_ms), 1));
+
+    const bool active = ble_connected && stream_subscribed();
+    if (active != stream_active) {
+      stream_active = active;
+      // new subscriber starts from key packet
+      band_stream_encoder_reset(&encoder);
+    }
+
+    band_stream_frame frame;
+    if (!active || !latest_slot_take(&stream_slot, &frame))
+      continue;
+
+    uint8_t packet[BAND_STREAM_MAX_PACKET];
+    const size_t len = band_stream_encode(&encoder, &frame,
+                                          d_options.stream_format & BAND_STREAM_DELTA,
+                                          packet, ble_mtu - 3);
+    if (len == 0)
+      continue;
+
+    stream_characteristic->setValue(packet, len);
+    stream_characteristic->notify();
   }
+}
 
-  spectrum_rgb_out(fft_io_buffer);
+void loop()
+{
+#if PROFILER_ENABLED
+  // timings report, the same as BLE one, but with histograms
+  static char report[1024];
+  delay(PROFILER_REPORT_PERIOD_MS);
+  profiler_report(report, sizeof(report), true);
+  Serial.print(report);
+#else
+  // all the work is done by analysis and output tasks
+  vTaskDelete(nullptr);
+#endif
 }
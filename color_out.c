@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "color_out.h"
+
+#include <math.h>
+
+void gamma_lut_init(struct gamma_lut* lut, float gamma)
+{
+  lut->gamma = gamma;
+  for (int i = 0; i <= GAMMA_LUT_STEPS; i++) {
+    const double x = (double)i / GAMMA_LUT_STEPS;
+    lut->table[i] = (uint16_t)lround(pow(x, gamma) * UINT16_MAX);
+  }
+}
+
+uint16_t gamma_lut_apply(const struct gamma_lut* lut, float x)
+{
+  if (!(x > 0.f))
+    return lut->table[0];
+  if (x >= 1.f)
+    return lut->table[GAMMA_LUT_STEPS];
+
+  const float pos = x * GAMMA_LUT_STEPS;
+  const int i = (int)pos;
+  const float f = pos - i;
+  const float a = lut->table[i];
+  const float b = lut->table[i + 1];
+  return (uint16_t)(a + f * (b - a) + 0.5f);
+}
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _COLOR_OUT_H_
+#define _COLOR_OUT_H_
+
+#include <stdint.h>
+
+// color output stage: gamma correction by lookup table into 16-bit
+// intermediate values, then temporal dithering down to output width,
+// so dark fades don't step on 8-bit LEDs, no pow() per frame
+
+// table resolution, input [0, 1] is split into this many steps,
+// values between entries are linearly interpolated
+#define GAMMA_LUT_STEPS   1024
+
+struct gamma_lut {
+  float gamma;                            // table is built for this value
+  uint16_t table[GAMMA_LUT_STEPS + 1];    // x^gamma, 0..65535
+};
+
+// builds table for given gamma, this is the only place pow() is used
+void gamma_lut_init(struct gamma_lut* lut, float gamma);
+
+// x^gamma as 16-bit value, x is clamped to [0, 1]
+// max error is about 1 (rounding) for gamma >= 1
+uint16_t gamma_lut_apply(const struct gamma_lut* lut, float x);
+
+// temporal dithering (error diffusion over frames) state of one channel,
+// quantization error of one frame is added to the next frame value,
+// so average output over frames matches 16-bit input
+struct dither_channel {
+  uint16_t error;   // accumulated error, in 16-bit units
+};
+
+// reduces 16-bit value to 'bits' (1..16) using channel state
+static inline uint32_t dither_quantize(struct dither_channel* ch,
+                                       uint16_t value, unsigned int bits)
+{
+  const unsigned int shift = 16 - bits;
+  const uint32_t max_out = (1u << bits) - 1;
+  const uint32_t acc = (uint32_t)value + ch->error;
+  uint32_t out = acc >> shift;
+  // full scale input doesn't fit, drop the error instead of wrapping
+  if (out > max_out) {
+    ch->error = 0;
+    return max_out;
+  }
+  ch->error = (uint16_t)(acc - (out << shift));
+  return out;
+}
+
+#endif /* _COLOR_OUT_H_ */
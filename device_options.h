@@ -5,11 +5,18 @@
 #define _DEVICE_OPTIONS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 struct device_opt {
   bool swap_r_b_channels;
   bool enable_rmt_history;
   float gamma_value;
+  uint8_t analyzer_bands;   // spectrum analyzer on LED strip, 0 - off
+  uint8_t output_rate;      // LEDs refresh rate, Hz
+  uint16_t attack_ms;       // band level rise time constant, 0 - instant
+  uint16_t release_ms;      // band level fall time constant, 0 - instant
+  uint8_t stream_points;    // spectrum points in BLE stream, 0 - bands only
+  uint8_t stream_format;    // BLE stream BAND_STREAM_* flags, see band_stream.h
 };
 
 #endif /* _DEVICE_OPTIONS_H_ */
@@ -4,22 +4,37 @@
 #include "device_options_ble.hpp"
 
 extern "C" {
+#include "audio_stats.h"
 #include "device_options.h"
 #include "filter.h"
+#include "profiler.h"
 #include "spectrum.h"
 }
 #include <esp_heap_caps.h>
 
 #include <BLE2901.h>
+#include <BLE2902.h>
 #include <BLE2904.h>
 
 #include <type_traits>
 
 extern String device_name;
+extern uint16_t analysis_hop;
+extern uint8_t input_decimation;
+extern bool multirate_analysis;
+extern uint8_t weighting_curve;
+extern uint16_t samples_count;
+extern uint8_t window_type;
 
 extern struct device_opt d_options;
 extern struct analysis_cfg acfg;
 extern struct filter_opt f_options;
+extern struct a2dp_stats a2dp_stats;
+extern struct analysis_stats analysis_stats;
+extern volatile uint32_t rmt_late_frames;
+
+void schedule_analysis_init();
+void schedule_audio_stats_reset();
 
 
 template<typename T>
@@ -106,6 +121,18 @@ uint8_t ConfigValue<uint8_t>::read(Preferences& prefs, const uint8_t& def)
   return prefs.getUChar(_key, def);
 }
 
+template<>
+void ConfigValue<uint16_t>::write(Preferences& prefs, const uint16_t& val)
+{
+  prefs.putUShort(_key, val);
+}
+
+template<>
+uint16_t ConfigValue<uint16_t>::read(Preferences& prefs, const uint16_t& def)
+{
+  return prefs.getUShort(_key, def);
+}
+
 template<>
 void ConfigValue<float>::write(Preferences& prefs, const float& val)
 {
@@ -239,8 +266,34 @@ static auto val_device_name = SimpleValue(device_name);
 static auto val_swap_channels = SimpleValue(d_options.swap_r_b_channels);
 static auto val_enable_history = SimpleValue(d_options.enable_rmt_history);
 static auto val_gamma_value = SimpleValue(d_options.gamma_value);
+static auto val_analyzer_bands = SimpleValue(d_options.analyzer_bands);
+// bands table is built with the other analysis tables
+static auto obs_analyzer_bands = ObservedValue(val_analyzer_bands, schedule_analysis_init);
+static auto val_output_rate = SimpleValue(d_options.output_rate);
+static auto val_attack_ms = SimpleValue(d_options.attack_ms);
+static auto val_release_ms = SimpleValue(d_options.release_ms);
+static auto val_stream_points = SimpleValue(d_options.stream_points);
+// stream points table is built with the other analysis tables
+static auto obs_stream_points = ObservedValue(val_stream_points, schedule_analysis_init);
+static auto val_stream_format = SimpleValue(d_options.stream_format);
+// not an option, any write resets audio statistics
+static bool audio_stats_reset = false;
+static auto val_stats_reset = SimpleValue(audio_stats_reset);
+static auto obs_stats_reset = ObservedValue(val_stats_reset, schedule_audio_stats_reset);
 
 static auto val_preamp = SimpleValue(acfg.preamp);
+static auto val_analysis_hop = SimpleValue(analysis_hop);
+static auto val_samples_count = SimpleValue(samples_count);
+static auto val_window_type = SimpleValue(window_type);
+static auto val_weighting_curve = SimpleValue(weighting_curve);
+static auto val_input_decimation = SimpleValue(input_decimation);
+static auto val_multirate = SimpleValue(multirate_analysis);
+// analysis tables depend on these values
+static auto obs_samples_count = ObservedValue(val_samples_count, schedule_analysis_init);
+static auto obs_window_type = ObservedValue(val_window_type, schedule_analysis_init);
+static auto obs_weighting_curve = ObservedValue(val_weighting_curve, schedule_analysis_init);
+static auto obs_input_decimation = ObservedValue(val_input_decimation, schedule_analysis_init);
+static auto obs_multirate = ObservedValue(val_multirate, schedule_analysis_init);
 static auto val_level_low = SimpleValue(f_options.level_low);
 static auto val_level_mid = SimpleValue(f_options.level_mid);
 static auto val_level_high = SimpleValue(f_options.level_high);
@@ -249,21 +302,41 @@ static auto val_thr_low = SimpleValue(f_options.thr_low);
 static auto val_thr_ml = SimpleValue(f_options.thr_ml);
 static auto val_thr_mh = SimpleValue(f_options.thr_mh);
 static auto val_thr_high = SimpleValue(f_options.thr_high);
+static auto val_band_reduction = SimpleValue(f_options.band_reduction);
+// filterbanks depend on these values
+static auto obs_thr_low = ObservedValue(val_thr_low, schedule_analysis_init);
+static auto obs_thr_ml = ObservedValue(val_thr_ml, schedule_analysis_init);
+static auto obs_thr_mh = ObservedValue(val_thr_mh, schedule_analysis_init);
+static auto obs_thr_high = ObservedValue(val_thr_high, schedule_analysis_init);
+static auto obs_band_reduction = ObservedValue(val_band_reduction, schedule_analysis_init);
 
 static auto opt_device_name = ConfigValue(val_device_name, "device", "dev_name");
 static auto opt_swap_channels = ConfigValue(val_swap_channels, "device", "swap_r_b");
 static auto opt_enable_history = ConfigValue(val_enable_history, "device", "rmt_history_en");
 static auto opt_gamma_value = ConfigValue(val_gamma_value, "device", "gamma_value");
+static auto opt_analyzer_bands = ConfigValue(obs_analyzer_bands, "device", "analyzer_bands");
+static auto opt_output_rate = ConfigValue(val_output_rate, "device", "output_rate");
+static auto opt_attack_ms = ConfigValue(val_attack_ms, "device", "attack_ms");
+static auto opt_release_ms = ConfigValue(val_release_ms, "device", "release_ms");
+static auto opt_stream_points = ConfigValue(obs_stream_points, "device", "stream_points");
+static auto opt_stream_format = ConfigValue(val_stream_format, "device", "stream_format");
 
 static auto opt_preamp = ConfigValue(val_preamp, "filter", "preamp");
+static auto opt_analysis_hop = ConfigValue(val_analysis_hop, "filter", "analysis_hop");
+static auto opt_samples_count = ConfigValue(obs_samples_count, "filter", "fft_size");
+static auto opt_window_type = ConfigValue(obs_window_type, "filter", "window");
+static auto opt_weighting_curve = ConfigValue(obs_weighting_curve, "filter", "weighting");
+static auto opt_input_decimation = ConfigValue(obs_input_decimation, "filter", "decimation");
+static auto opt_multirate = ConfigValue(obs_multirate, "filter", "multirate");
 static auto opt_level_low = ConfigValue(val_level_low, "filter", "level_low");
 static auto opt_level_mid = ConfigValue(val_level_mid, "filter", "level_mid");
 static auto opt_level_high = ConfigValue(val_level_high, "filter", "level_high");
 
-static auto opt_thr_low = ConfigValue(val_thr_low, "filter", "thr_low");
-static auto opt_thr_ml = ConfigValue(val_thr_ml, "filter", "thr_ml");
-static auto opt_thr_mh = ConfigValue(val_thr_mh, "filter", "thr_mh");
-static auto opt_thr_high = ConfigValue(val_thr_high, "filter", "thr_high");
+static auto opt_thr_low = ConfigValue(obs_thr_low, "filter", "thr_low");
+static auto opt_thr_ml = ConfigValue(obs_thr_ml, "filter", "thr_ml");
+static auto opt_thr_mh = ConfigValue(obs_thr_mh, "filter", "thr_mh");
+static auto opt_thr_high = ConfigValue(obs_thr_high, "filter", "thr_high");
+static auto opt_band_reduction = ConfigValue(obs_band_reduction, "filter", "band_reduction");
 
 void load_values_from_config()
 {
@@ -271,8 +344,20 @@ void load_values_from_config()
   opt_swap_channels.load();
   opt_enable_history.load();
   opt_gamma_value.load();
+  opt_analyzer_bands.load();
+  opt_output_rate.load();
+  opt_attack_ms.load();
+  opt_release_ms.load();
+  opt_stream_points.load();
+  opt_stream_format.load();
 
   opt_preamp.load();
+  opt_analysis_hop.load();
+  opt_samples_count.load();
+  opt_window_type.load();
+  opt_weighting_curve.load();
+  opt_input_decimation.load();
+  opt_multirate.load();
   opt_level_low.load();
   opt_level_mid.load();
   opt_level_high.load();
@@ -281,6 +366,7 @@ void load_values_from_config()
   opt_thr_ml.load();
   opt_thr_mh.load();
   opt_thr_high.load();
+  opt_band_reduction.load();
 }
 
 static uint32_t get_minimum_free_mem()
@@ -288,6 +374,17 @@ static uint32_t get_minimum_free_mem()
   return heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
 }
 
+#if PROFILER_ENABLED
+static String get_profiler_report()
+{
+  // without histograms, they don't fit into characteristic value,
+  // full report is printed to serial
+  char report[512];
+  profiler_report(report, sizeof(report), false);
+  return report;
+}
+#endif
+
 void ble_add_device_characteristics(BLEService* service)
 {
   ble_add_rw_value(service, opt_device_name,
@@ -307,11 +404,94 @@ void ble_add_device_characteristics(BLEService* service)
                    "47f5321d-27af-4ec4-b44f-49b082cf0505",
                    fmt_float_u16,
                    "Gamma value");
+  ble_add_rw_value(service, opt_analyzer_bands,
+                   "c6a2f0d8-4e1b-4f7a-a35c-9d82b71e04f3",
+                   fmt_u8_raw,
+                   "Spectrum analyzer bands on LED strip (0 - off, up to 32)");
+  ble_add_rw_value(service, opt_output_rate,
+                   "0d7b3e52-8a41-4c96-b1f7-5e28c3a9d640",
+                   fmt_u8_raw,
+                   "LEDs refresh rate in Hz (10-200)");
+  ble_add_rw_value(service, opt_attack_ms,
+                   "9f4c62a1-3d08-47e5-8b2a-c71e05d4b389",
+                   fmt_u16_raw,
+                   "Band level attack time in ms (0 - instant)");
+  ble_add_rw_value(service, opt_release_ms,
+                   "5e81d0c7-b2f3-4a69-9c45-18a6e7f23b0d",
+                   fmt_u16_raw,
+                   "Band level release time in ms (0 - instant)");
+  ble_add_rw_value(service, opt_stream_points,
+                   "4b0e8d63-f2a7-4c19-95d8-a36c1e7f0b52",
+                   fmt_u8_raw,
+                   "Spectrum points in live stream (0 - bands only, up to 32)");
+  ble_add_rw_value(service, opt_stream_format,
+                   "e7c31f94-0a5d-4b86-8e2f-59d4b06a1c37",
+                   fmt_u8_raw,
+                   "Live stream format (bit 0 - bands in dB, bit 1 - delta)");
 
   ble_add_ro_value(service, get_minimum_free_mem,
                    "32a34428-4456-4d62-a2f5-2fc7eaadeb97",
                    fmt_u32_raw,
                    "Total minimum free memory since boot");
+
+  // audio path health, since boot or the last reset
+  ble_add_ro_value(service, [] { return a2dp_stats.dropped_bytes; },
+                   "e4a1c9d2-5b37-4f80-9a6e-13d7f0b2c845",
+                   fmt_u32_raw,
+                   "Audio bytes dropped (ring buffer full)");
+  ble_add_ro_value(service, [] { return a2dp_stats.ring_high_water; },
+                   "7b3f2e81-c64d-4a95-b0d2-8e51a9c7f306",
+                   fmt_u32_raw,
+                   "Ring buffer high-water mark in bytes");
+  ble_add_ro_value(service, [] { return analysis_stats.frames; },
+                   "2d9c5a17-e8b4-4c63-a1f0-6b47d3e92a58",
+                   fmt_u32_raw,
+                   "Frames analyzed");
+  ble_add_ro_value(service, [] { return analysis_stats.timeouts; },
+                   "c1e86f3b-29a7-4d05-8b94-f52d0e7a1c63",
+                   fmt_u32_raw,
+                   "Audio receive timeouts (no input)");
+  ble_add_ro_value(service, [] { return a2dp_stats.packets; },
+                   "58f0b4e2-a1d9-4e76-93c8-0d2b7f6e4a19",
+                   fmt_u32_raw,
+                   "A2DP packets received");
+  ble_add_ro_value(service, [] { return a2dp_stats.packet_min; },
+                   "9a4d7c30-6e5f-4b18-a2c9-e83f1b5d7026",
+                   fmt_u32_raw,
+                   "A2DP min packet size in bytes");
+  ble_add_ro_value(service, [] { return a2dp_stats.packet_max; },
+                   "f6b2e953-0c8a-4d17-be41-7a95c3d2e8f0",
+                   fmt_u32_raw,
+                   "A2DP max packet size in bytes");
+  ble_add_ro_value(service, [] { return a2dp_stats.interval_max_us; },
+                   "3e7a91c5-d4f2-4b60-8c1e-b05f6a2d9c74",
+                   fmt_u32_raw,
+                   "A2DP max packet interval in us");
+  ble_add_ro_value(service, [] { return rmt_late_frames; },
+                   "6c2f8d14-a93e-4b57-8e06-d1b5f7a3c982",
+                   fmt_u32_raw,
+                   "LED strip frames skipped (strip busy)");
+  ble_add_rw_value(service, obs_stats_reset,
+                   "a85d0f6c-7b13-4e92-9d4a-c2e6f1b83a57",
+                   fmt_bool,
+                   "Write to reset audio statistics");
+#if PROFILER_ENABLED
+  // reset together with audio statistics
+  ble_add_ro_value(service, get_profiler_report,
+                   "d3b86a1e-52c4-4f07-a9e3-7c1f0b6d2e94",
+                   fmt_string,
+                   "Frame path timings report");
+#endif
+}
+
+BLECharacteristic* ble_add_stream_characteristic(BLEService* service)
+{
+  constexpr auto props = BLECharacteristic::PROPERTY_NOTIFY;
+  auto c = service->createCharacteristic("1f6d9b27-c853-4e0a-b7d4-820e6a3f5c91", props);
+  // client subscription, sender checks it
+  c->addDescriptor(new BLE2902());
+  ble_characteristic_add_description(c, "Live bands and spectrum, see band_stream.h");
+  return c;
 }
 
 template<typename R, typename T>
@@ -328,6 +508,30 @@ void ble_add_filter_characteristics(BLEService* service)
                    "ef599dd1-35ad-4a35-a367-e4401693f02a",
                    fmt_float_u16,
                    "Input preamplifier gain");
+  ble_add_rw_value(service, opt_analysis_hop,
+                   "7e1663e4-db94-4402-aba1-462036a35568",
+                   fmt_u16_raw,
+                   "Analysis hop size in samples");
+  ble_add_rw_value(service, opt_samples_count,
+                   "d1e3a4c2-5f0b-4e8a-9c36-7b2f1e6d8a45",
+                   fmt_u16_raw,
+                   "FFT size in samples (256-4096, power of 2)");
+  ble_add_rw_value(service, opt_window_type,
+                   "a97c3b15-2e64-4f0d-b8d1-0c5e9f3a7b62",
+                   fmt_u8_raw,
+                   "Window function (0 - Hann, 1 - Blackman-Harris, 2 - flat-top)");
+  ble_add_rw_value(service, opt_weighting_curve,
+                   "4b155cc9-c30b-4c47-898e-78aa9c3c6eed",
+                   fmt_u8_raw,
+                   "Frequency weighting curve (0 - log-log, 1 - A, 2 - flat)");
+  ble_add_rw_value(service, opt_input_decimation,
+                   "3c9e7a14-6b2d-4f85-a0e3-d5172b8c6f49",
+                   fmt_u8_raw,
+                   "Input sample rate divider (1 or 2)");
+  ble_add_rw_value(service, opt_multirate,
+                   "b6f1d29e-47a3-4c08-9e5d-2a83c7f4e160",
+                   fmt_bool,
+                   "Multirate analysis (finer bass bins)");
   ble_add_rw_value(service, opt_level_low,
                    "26ebeecb-c65e-4769-8bce-932e6814580e",
                    fmt_float_u16,
@@ -357,4 +561,8 @@ void ble_add_filter_characteristics(BLEService* service)
                    "84dbac92-e7b4-4f70-97bb-a9ffdaa9393e",
                    fmt_u8_raw,
                    "High frequency filter threshold");
+  ble_add_rw_value(service, opt_band_reduction,
+                   "e82d5f3a-91c4-4b6e-a7d0-36f1c9b8e254",
+                   fmt_u8_raw,
+                   "Band level (0 - max magnitude, 1 - triangular filterbank)");
 }
@@ -13,6 +13,8 @@ void load_values_from_config();
 
 void ble_add_device_characteristics(BLEService* service);
 void ble_add_filter_characteristics(BLEService* service);
+// live levels stream, notify only, value is set by the sender
+BLECharacteristic* ble_add_stream_characteristic(BLEService* service);
 
 
 template<typename T>
@@ -58,6 +60,31 @@ private:
 };
 
 
+// calls given function after each value change
+template<typename T>
+class ObservedValue : public ValueDecorator<T>
+{
+  using Parent = ValueDecorator<T>;
+
+public:
+  using callback_type = std::function<void()>;
+
+  ObservedValue(Value<T>& val, callback_type on_changed) noexcept
+    : ValueDecorator<T>(val)
+    , _on_changed(std::move(on_changed))
+  {}
+
+  void set(T v) override
+  {
+    Parent::set(std::move(v));
+    _on_changed();
+  }
+
+private:
+  callback_type _on_changed;
+};
+
+
 template<typename T>
 class ConfigValue : public ValueDecorator<T>
 {
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "envelope.h"
+
+#include <math.h>
+
+float envelope_coef(float tau_ms, float rate_hz)
+{
+  if (!(tau_ms > 0.f) || !(rate_hz > 0.f))
+    return 1.f;
+  return 1.f - expf(-1000.f / (tau_ms * rate_hz));
+}
+
+void envelope_init(struct envelope_cfg* cfg, float attack_ms,
+                   float release_ms, float rate_hz)
+{
+  cfg->attack = envelope_coef(attack_ms, rate_hz);
+  cfg->release = envelope_coef(release_ms, rate_hz);
+}
+
+void envelope_update(const struct envelope_cfg* cfg, float* level,
+                     const float* target, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    const float d = target[i] - level[i];
+    level[i] += (d > 0 ? cfg->attack : cfg->release) * d;
+  }
+}
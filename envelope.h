@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _ENVELOPE_H_
+#define _ENVELOPE_H_
+
+#include <stddef.h>
+
+// attack/release envelope follower, moves levels towards target with
+// one-pole smoothing, faster when level rises (attack) than when it
+// falls (release), used to refresh output at fixed rate, independent
+// from analysis rate
+struct envelope_cfg {
+  float attack;     // per update step coefficient, 1 - jump to target
+  float release;
+};
+
+// per update step coefficient for given time constant: level covers
+// 1 - 1/e of the distance to target in tau_ms, tau_ms <= 0 - no smoothing
+float envelope_coef(float tau_ms, float rate_hz);
+
+void envelope_init(struct envelope_cfg* cfg, float attack_ms,
+                   float release_ms, float rate_hz);
+
+// one update step of n independent levels
+void envelope_update(const struct envelope_cfg* cfg, float* level,
+                     const float* target, size_t n);
+
+#endif /* _ENVELOPE_H_ */
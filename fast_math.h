@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _FAST_MATH_H_
+#define _FAST_MATH_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// replace libm functions used in the analysis and output hot path
+// with approximations below, build-time switch, affects math_*()
+#ifndef FAST_MATH_APPROX
+#define FAST_MATH_APPROX  0
+#endif
+
+// approximations, max errors are checked by bench/dsp_bench
+// all of them are for float arguments in the ranges this project
+// deals with: positive normal numbers, no special values handling
+
+static inline uint32_t fast_math_bits(float x)
+{
+  uint32_t u;
+  memcpy(&u, &x, sizeof(u));
+  return u;
+}
+
+static inline float fast_math_float(uint32_t u)
+{
+  float x;
+  memcpy(&x, &u, sizeof(x));
+  return x;
+}
+
+// sqrt(x*x + y*y) without overflow protection libm does,
+// FFT magnitudes are far from float limits
+// max relative error: 3e-7 (rounding only)
+static inline float fast_hypot(float x, float y)
+{
+  return sqrtf(x * x + y * y);
+}
+
+// log2(x), x > 0, x is split into exponent and mantissa in
+// [sqrt(0.5), sqrt(2)), log2(1+t) = t*P(t), P is degree 6
+// max absolute error: 7e-7 + float rounding of the result
+static inline float fast_log2(float x)
+{
+  // mantissa range starts from sqrt(0.5), not 1, so subtract its
+  // bits, exponent field becomes exactly what is needed
+  const int32_t ix = (int32_t)fast_math_bits(x) - 0x3f3504f3;
+  const int32_t e = ix >> 23;
+  const float m = fast_math_float(fast_math_bits(x) - ((uint32_t)e << 23));
+  const float t = m - 1;
+  float p = 0.168186591f;
+  p = p * t - 0.267963871f;
+  p = p * t + 0.296119557f;
+  p = p * t - 0.359524455f;
+  p = p * t + 0.480613125f;
+  p = p * t - 0.721360179f;
+  p = p * t + 1.442696523f;
+  return e + t * p;
+}
+
+// 2^x, x = i + f, f in [-0.5, 0.5], 2^f is polynomial of degree 5
+// results below 2^-126 are flushed to 0, above 2^127 are infinity
+// max relative error: 2e-7 + float rounding of the argument
+static inline float fast_exp2(float x)
+{
+  if (x < -126.f)
+    return 0.f;
+  if (x > 127.f)
+    return INFINITY;
+
+  // adding 1.5*2^23 rounds x to integer, which ends up in the
+  // lowest mantissa bits (this doesn't survive -ffast-math)
+  const float shifter = 12582912.f;
+  const float r = x + shifter;
+  const int32_t i = (int32_t)fast_math_bits(r) - 0x4b400000;
+  const float f = x - (r - shifter);
+  float p = 0.00133908634f;
+  p = p * f + 0.00967603192f;
+  p = p * f + 0.0555035711f;
+  p = p * f + 0.240221075f;
+  p = p * f + 0.693147188f;
+  p = p * f + 1.00000008f;
+  return p * fast_math_float((uint32_t)(i + 127) << 23);
+}
+
+// log10(x), x > 0
+// max absolute error: 1e-6 for x in [1e-7, 10] (magnitudes)
+static inline float fast_log10(float x)
+{
+  return fast_log2(x) * 0.301029996f;   // log10(2)
+}
+
+// natural logarithm, x > 0
+// max absolute error: 2e-6 for x in [1e-7, 10]
+static inline float fast_log(float x)
+{
+  return fast_log2(x) * 0.693147181f;   // ln(2)
+}
+
+// x^y, x >= 0, computed as 2^(y*log2(x))
+// max relative error: 5e-6 for x in [1e-4, 1], y in [1, 4] (gamma)
+static inline float fast_pow(float x, float y)
+{
+  if (x == 0.f)
+    return 0.f;
+  return fast_exp2(y * fast_log2(x));
+}
+
+// selected by FAST_MATH_APPROX implementations, used by the project code
+
+static inline float math_hypot(float x, float y)
+{
+#if FAST_MATH_APPROX
+  return fast_hypot(x, y);
+#else
+  return hypotf(x, y);
+#endif
+}
+
+static inline float math_log10(float x)
+{
+#if FAST_MATH_APPROX
+  return fast_log10(x);
+#else
+  return log10f(x);
+#endif
+}
+
+static inline float math_pow(float x, float y)
+{
+#if FAST_MATH_APPROX
+  return fast_pow(x, y);
+#else
+  return powf(x, y);
+#endif
+}
+
+// log(log(x)), x > 1
+// fast variant max absolute error: 1e-6 for x in [10, 24000]
+static inline float math_loglog(float x)
+{
+#if FAST_MATH_APPROX
+  return fast_log(fast_log(x));
+#else
+  return logf(logf(x));
+#endif
+}
+
+#endif /* _FAST_MATH_H_ */
@@ -3,20 +3,216 @@
 
 #include "filter.h"
 
+#include <math.h>
+
 #include "spectrum.h"
 
-void spectrum_lmh_out(const float* spectrum, size_t n, float out[3],
-                      const struct filter_opt* opt)
+static inline uint16_t clamp_index(uint8_t thr, size_t n)
+{
+  return thr < n ? thr : n-1;
+}
+
+void spectrum_lmh_bands(uint16_t bands[6], const struct filter_opt* opt, size_t n)
 {
-  const uint16_t bands[] = {
-    0, opt->thr_low,
-    opt->thr_ml, opt->thr_mh,
-    opt->thr_high, n-1,
-  };
+  bands[0] = 0;
+  bands[1] = clamp_index(opt->thr_low, n);
+  bands[2] = clamp_index(opt->thr_ml, n);
+  bands[3] = clamp_index(opt->thr_mh, n);
+  bands[4] = clamp_index(opt->thr_high, n);
+  bands[5] = n-1;
+}
 
-  spectrum_bars(3, out, bands, spectrum, n);
+void spectrum_lmh_out(const float* spectrum, size_t n, float out[3],
+                      const uint16_t bands[6], const struct filter_opt* opt,
+                      const struct spectrum_filterbank* fb)
+{
+  if (fb && opt->band_reduction == BAND_REDUCTION_FILTERBANK)
+    spectrum_filterbank_out(spectrum, fb, out);
+  else
+    spectrum_bars(3, out, bands, spectrum, n);
 
   out[0] *= opt->level_low;
   out[1] *= opt->level_mid;
   out[2] *= opt->level_high;
 }
+
+void spectrum_lmh_setup(struct analysis_cfg* cfg,
+                        const struct filter_opt* opt)
+{
+  if (cfg->engine == ANALYSIS_ENGINE_Q15)
+    return;
+
+  const size_t n = cfg->fft_cfg->n;
+  // only the high band is estimated, everything below is exact
+  const int lm_below_high = opt->thr_low < opt->thr_high &&
+                            opt->thr_ml < opt->thr_high &&
+                            opt->thr_mh < opt->thr_high &&
+                            opt->thr_high < n;
+
+  // weighted average needs all magnitudes of the high band
+  const int max_reduction = opt->band_reduction == BAND_REDUCTION_MAX;
+
+  if (lm_below_high && max_reduction &&
+      opt->thr_high <= pruned_analysis_max_bins(n)) {
+    cfg->engine = ANALYSIS_ENGINE_PRUNED;
+    cfg->exact_bins = opt->thr_high;
+  } else {
+    cfg->engine = ANALYSIS_ENGINE_FLOAT;
+  }
+}
+
+void spectrum_bands_hz(struct spectrum_bands* bands, const float* edges_hz,
+                       uint8_t count, size_t sample_rate, size_t nfft)
+{
+  if (count > MAX_SPECTRUM_BANDS)
+    count = MAX_SPECTRUM_BANDS;
+
+  bands->count = count;
+  for (uint8_t i = 0; i <= count; i++) {
+    // the first index with frequency not below the edge,
+    // spectrum index i is FFT bin i+1, see frequencies_data()
+    float bin = ceilf(edges_hz[i] * 2 * nfft / sample_rate);
+    size_t e = bin > 1 ? (size_t)bin - 1 : 0;
+    // every band has at least one index
+    if (i > 0 && e <= bands->edges[i-1])
+      e = bands->edges[i-1] + 1;
+    bands->edges[i] = e < nfft ? e : nfft;
+  }
+}
+
+void spectrum_bands_log(struct spectrum_bands* bands, uint8_t count,
+                        float f_min, float f_max,
+                        size_t sample_rate, size_t nfft)
+{
+  if (count > MAX_SPECTRUM_BANDS)
+    count = MAX_SPECTRUM_BANDS;
+
+  float edges_hz[MAX_SPECTRUM_BANDS + 1];
+  for (uint8_t i = 0; i <= count; i++)
+    edges_hz[i] = f_min * powf(f_max / f_min, count ? (float)i / count : 0);
+
+  spectrum_bands_hz(bands, edges_hz, count, sample_rate, nfft);
+}
+
+void spectrum_bands_out(const float* spectrum,
+                        const struct spectrum_bands* bands, float* out)
+{
+  const float* m = spectrum + 2*bands->edges[0] + 1;
+  for (uint8_t b = 0; b < bands->count; b++) {
+    float level = 0;
+    for (uint16_t i = bands->edges[b]; i < bands->edges[b+1]; i++) {
+      if (*m > level)
+        level = *m;
+      m += 2;
+    }
+    out[b] = level;
+  }
+}
+
+void spectrum_bands_setup(struct analysis_cfg* cfg,
+                          const struct spectrum_bands* bands)
+{
+  if (cfg->engine == ANALYSIS_ENGINE_PRUNED && bands->count > 0 &&
+      bands->edges[bands->count] > cfg->exact_bins)
+    cfg->engine = ANALYSIS_ENGINE_FLOAT;
+}
+
+// adds triangle with feet at l and r and peak at p (fractional
+// spectrum indexes, l < p < r), clipped to [b, e), weights sum is 1
+// weights - band weights output, may be NULL, returns weights count
+static uint16_t add_triangle(struct spectrum_filterbank* fb, uint8_t band,
+                             float* weights, float l, float p, float r,
+                             size_t b, size_t e)
+{
+  // indexes strictly inside (l, r), there is at least one
+  size_t first = l < 0 ? 0 : (size_t)floorf(l) + 1;
+  size_t last = (size_t)ceilf(r) - 1;
+  if (first < b) first = b;
+  if (last >= e) last = e - 1;
+
+  fb->start[band] = first;
+  fb->length[band] = last - first + 1;
+
+  if (!weights)
+    return fb->length[band];
+
+  float sum = 0;
+  for (size_t i = first; i <= last; i++) {
+    float w = 1;
+    if (i < p)
+      w = (i - l) / (p - l);
+    if (i > p)
+      w = (r - i) / (r - p);
+    weights[i - first] = w;
+    sum += w;
+  }
+  for (uint16_t i = 0; i < fb->length[band]; i++)
+    weights[i] /= sum;
+
+  return fb->length[band];
+}
+
+size_t spectrum_filterbank_bands(struct spectrum_filterbank* fb, float* weights,
+                                 const struct spectrum_bands* bands)
+{
+  const uint8_t n = bands->count;
+  const uint16_t* edges = bands->edges;
+  size_t total = 0;
+
+  fb->count = n;
+  fb->weights = weights;
+  for (uint8_t i = 0; i < n; i++) {
+    const uint16_t b = edges[i];
+    const uint16_t e = edges[i+1];
+    // empty band (above Nyquist) stays empty
+    if (b == e) {
+      fb->start[i] = 0;
+      fb->length[i] = 0;
+      continue;
+    }
+    // feet are at neighbours centers, the outer neighbours
+    // are replaced by the indexes just outside the bands
+    const float c = (b + e - 1) / 2.f;
+    const float l = i > 0 ? (edges[i-1] + b - 1) / 2.f : b - 1;
+    const float r = i + 1 < n && edges[i+2] > e ? (e + edges[i+2] - 1) / 2.f : e;
+    total += add_triangle(fb, i, weights ? weights + total : NULL,
+                          l, c, r, edges[0], edges[n]);
+  }
+  return total;
+}
+
+size_t spectrum_filterbank_lmh(struct spectrum_filterbank* fb, float* weights,
+                               const uint16_t bands[6], size_t n)
+{
+  size_t total = 0;
+  fb->count = 3;
+  fb->weights = weights;
+  for (uint8_t i = 0; i < 3; i++) {
+    const uint16_t first = bands[2*i];
+    const uint16_t last = bands[2*i + 1];
+    // the same as spectrum_bars(), such band is not calculated
+    if (first >= n || last >= n || first > last) {
+      fb->start[i] = 0;
+      fb->length[i] = 0;
+      continue;
+    }
+    total += add_triangle(fb, i, weights ? weights + total : NULL,
+                          first - 1, (first + last) / 2.f, last + 1,
+                          first, last + 1);
+  }
+  return total;
+}
+
+void spectrum_filterbank_out(const float* spectrum,
+                             const struct spectrum_filterbank* fb, float* out)
+{
+  const float* w = fb->weights;
+  for (uint8_t b = 0; b < fb->count; b++) {
+    const float* m = spectrum + 2*fb->start[b] + 1;
+    float level = 0;
+    for (uint16_t i = 0; i < fb->length[b]; i++)
+      level += w[i] * m[2*i];
+    w += fb->length[b];
+    out[b] = level;
+  }
+}
@@ -7,6 +7,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+// how band level is calculated from its magnitudes
+enum band_reduction {
+  BAND_REDUCTION_MAX,         // the largest magnitude, see spectrum_bars()
+  BAND_REDUCTION_FILTERBANK,  // triangular weighted average, see below
+};
+
 struct filter_opt {
   float level_low;
   float level_mid;
@@ -16,9 +22,104 @@ struct filter_opt {
   uint8_t thr_ml;
   uint8_t thr_mh;
   uint8_t thr_high;
+
+  uint8_t band_reduction;   // see enum band_reduction
 };
 
+struct analysis_cfg;
+struct spectrum_filterbank;
+
+// 3 bands [first index, last index] pairs, as spectrum_bars() wants,
+// low band ends at thr_low, mid one is [thr_ml, thr_mh], high one
+// starts at thr_high, thresholds are limited to the last index, so
+// with small FFT bands become narrower instead of disappearing
+// n - spectrum elements count
+void spectrum_lmh_bands(uint16_t bands[6], const struct filter_opt* opt, size_t n);
+
+// bands - 3 bands, see spectrum_lmh_bands(), thresholds in opt are
+// not used, so bands may be for another spectrum (e.g. merged one)
+// fb - filterbank for these bands (see spectrum_filterbank_lmh()),
+// used if opt->band_reduction asks for it, may be NULL otherwise
 void spectrum_lmh_out(const float* spectrum, size_t n, float out[3],
-                      const struct filter_opt* opt);
+                      const uint16_t bands[6], const struct filter_opt* opt,
+                      const struct spectrum_filterbank* fb);
+
+// chooses analysis engine for spectrum_lmh_out() with given options:
+// pruned engine if low and mid bands are below the high band and
+// calculating them directly is cheaper than FFT (and bands levels
+// are the largest magnitudes), float one otherwise, fixed-point
+// engine is never changed (it is build-time choice)
+void spectrum_lmh_setup(struct analysis_cfg* cfg,
+                        const struct filter_opt* opt);
+
+// max bands count supported by spectrum_bands
+#define MAX_SPECTRUM_BANDS  32
+
+// N-band spectrum layout (e.g. for spectrum analyzer effects),
+// bands are adjacent, so all of them are reduced in one pass,
+// band i covers spectrum indexes [edges[i], edges[i+1])
+struct spectrum_bands {
+  uint8_t count;
+  uint16_t edges[MAX_SPECTRUM_BANDS + 1];
+};
+
+// builds bands from their edges in Hz, done once per sample rate
+// and FFT size, bands narrower than one FFT bin are widened up to
+// it, bands above the Nyquist frequency are empty
+// edges_hz - count+1 ascending frequencies
+// count - bands count, up to MAX_SPECTRUM_BANDS
+// sample_rate - input sample rate, Hz
+// nfft - FFTs count, the same as in FFT configuration
+void spectrum_bands_hz(struct spectrum_bands* bands, const float* edges_hz,
+                       uint8_t count, size_t sample_rate, size_t nfft);
+
+// the same as spectrum_bands_hz(), but edges are log-spaced
+// from f_min to f_max Hz, i.e. all bands are the same in octaves
+void spectrum_bands_log(struct spectrum_bands* bands, uint8_t count,
+                        float f_min, float f_max,
+                        size_t sample_rate, size_t nfft);
+
+// reduces spectrum to bands levels, max magnitude in each band
+// out - output buffer, size is bands->count, empty bands are 0
+void spectrum_bands_out(const float* spectrum,
+                        const struct spectrum_bands* bands, float* out);
+
+// call after spectrum_lmh_setup(), falls back to float engine if
+// bands need magnitudes pruned engine doesn't calculate exactly
+void spectrum_bands_setup(struct analysis_cfg* cfg,
+                          const struct spectrum_bands* bands);
+
+// sparse triangular filterbank, band level is weighted average of
+// its magnitudes, this is much more stable than the largest magnitude
+// for wide bands, only non-zero weights are stored, so the cost is
+// proportional to their count, not to bands count * FFT size
+struct spectrum_filterbank {
+  uint8_t count;
+  uint16_t start[MAX_SPECTRUM_BANDS];   // the first weighted index
+  uint16_t length[MAX_SPECTRUM_BANDS];  // weights count
+  const float* weights;   // all bands weights, one band after another
+};
+
+// max weights count filterbank builders below may need
+#define FILTERBANK_MAX_WEIGHTS(nfft)  (3*(nfft))
+
+// builds mel-style filterbank for N-band layout: triangle of each band
+// has peak at its center and goes to zero at neighbours centers, so
+// adjacent triangles overlap by half, weights are normalized to sum 1
+// weights - buffer for weights, may be NULL, then only count is returned
+// returns weights count
+size_t spectrum_filterbank_bands(struct spectrum_filterbank* fb, float* weights,
+                                 const struct spectrum_bands* bands);
+
+// builds filterbank for 3 bands used by spectrum_lmh_out(), triangle
+// of each band covers the whole band, with peak at its center
+// bands, n - the same as for spectrum_lmh_out()
+// weights and return value are the same as above
+size_t spectrum_filterbank_lmh(struct spectrum_filterbank* fb, float* weights,
+                               const uint16_t bands[6], size_t n);
+
+// calculates bands levels, out size is fb->count
+void spectrum_filterbank_out(const float* spectrum,
+                             const struct spectrum_filterbank* fb, float* out);
 
 #endif /* _FILTER_H_ */
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "latest_slot.h"
+
+#include <string.h>
+
+// shared state: buffer index in the low bits, plus this flag
+// when it has item consumer didn't take yet
+#define SLOT_FRESH  0x4
+#define SLOT_INDEX  0x3
+
+// GCC atomic builtins, the same as in spsc_queue.c
+#define load_relaxed(p)       __atomic_load_n((p), __ATOMIC_RELAXED)
+#define exchange_acq_rel(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+
+void latest_slot_init(struct latest_slot* s, void* buffer, size_t item_size)
+{
+  s->buffer = buffer;
+  s->item_size = item_size;
+  s->write = 0;
+  s->read = 1;
+  s->shared = 2;
+}
+
+static inline uint8_t* item_at(const struct latest_slot* s, uint8_t index)
+{
+  return s->buffer + (size_t)index * s->item_size;
+}
+
+void latest_slot_publish(struct latest_slot* s, const void* item)
+{
+  memcpy(item_at(s, s->write), item, s->item_size);
+  // release: item data is visible before its buffer becomes shared,
+  // acquire: consumer is done with the buffer producer gets back
+  const uint8_t prev = exchange_acq_rel(&s->shared, s->write | SLOT_FRESH);
+  s->write = prev & SLOT_INDEX;
+}
+
+bool latest_slot_take(struct latest_slot* s, void* item)
+{
+  if (!(load_relaxed(&s->shared) & SLOT_FRESH))
+    return false;
+
+  // only producer sets the flag, so it is still there, maybe
+  // with even newer buffer
+  const uint8_t prev = exchange_acq_rel(&s->shared, s->read);
+  s->read = prev & SLOT_INDEX;
+  memcpy(item, item_at(s, s->read), s->item_size);
+  return true;
+}
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _LATEST_SLOT_H_
+#define _LATEST_SLOT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// lock-free single-producer / single-consumer "latest value" slot,
+// unlike queue, it keeps only the newest item, publish() always
+// succeeds and overwrites not yet taken item, take() gets the newest
+// one, so slow consumer never holds producer back
+// triple buffer: producer and consumer own one buffer each, the third
+// one is exchanged with shared state atomically, no locks and no waiting
+struct latest_slot {
+  uint8_t* buffer;    // items storage, 3 * item_size bytes
+  size_t item_size;   // item size, bytes
+  uint8_t write;      // producer buffer index, written by producer
+  uint8_t read;       // consumer buffer index, written by consumer
+  uint8_t shared;     // the third buffer index and "new item" flag
+};
+
+// initializes empty slot
+// buffer - items storage, 3 * item_size bytes
+// item_size - item size, bytes
+void latest_slot_init(struct latest_slot* s, void* buffer, size_t item_size);
+
+// copies item into the slot, producer side
+void latest_slot_publish(struct latest_slot* s, const void* item);
+
+// copies the newest item out of the slot, consumer side
+// returns false if nothing was published since the previous call,
+// item is not changed then
+bool latest_slot_take(struct latest_slot* s, void* item);
+
+#endif /* _LATEST_SLOT_H_ */
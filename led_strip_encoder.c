@@ -9,12 +9,20 @@
 
 static const char *TAG = "led_encoder";
 
+// pattern encoder generates pixels by chunks of this size
+#define LED_STRIP_CHUNK_PIXELS  16
+#define LED_STRIP_PIXEL_BYTES   3
+
 typedef struct {
     rmt_encoder_t base;
     rmt_encoder_t *bytes_encoder;
     rmt_encoder_t *copy_encoder;
     int state;
     rmt_symbol_word_t reset_code;
+    // pattern encoder only: the next pixel to generate and the chunk being encoded
+    size_t next_pixel;
+    size_t chunk_size;
+    uint8_t chunk[LED_STRIP_CHUNK_PIXELS * LED_STRIP_PIXEL_BYTES];
 } rmt_led_strip_encoder_t;
 
 RMT_ENCODER_FUNC_ATTR
@@ -26,9 +34,11 @@ static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t
     rmt_encode_state_t session_state = RMT_ENCODING_RESET;
     rmt_encode_state_t state = RMT_ENCODING_RESET;
     size_t encoded_symbols = 0;
+    const led_strip_spans_t *spans = (const led_strip_spans_t *)primary_data;
+    (void)data_size;
     switch (led_encoder->state) {
-    case 0: // send RGB data
-        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+    case 0: // send the first span of RGB data
+        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, spans->first, spans->first_size, &session_state);
         if (session_state & RMT_ENCODING_COMPLETE) {
             led_encoder->state = 1; // switch to next state when current encoding session finished
         }
@@ -37,11 +47,79 @@ static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t
             goto out; // yield if there's no free space for encoding artifacts
         }
     // fall-through
+    case 1: // send the second span of RGB data, if any
+        if (spans->second_size > 0) {
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, spans->second, spans->second_size, &session_state);
+        } else {
+            session_state = RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = 2; // switch to next state when current encoding session finished
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    // fall-through
+    case 2: // send reset code
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+RMT_ENCODER_FUNC_ATTR
+static size_t rmt_encode_led_strip_pattern(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    const led_strip_pattern_t *pattern = (const led_strip_pattern_t *)primary_data;
+    (void)data_size;
+    switch (led_encoder->state) {
+    case 0: // generate RGB data chunk by chunk and send it
+        while (led_encoder->chunk_size > 0 || led_encoder->next_pixel < pattern->count) {
+            // chunk is kept until it is completely encoded, bytes encoder may need it again after yield
+            if (led_encoder->chunk_size == 0) {
+                size_t count = pattern->count - led_encoder->next_pixel;
+                if (count > LED_STRIP_CHUNK_PIXELS) {
+                    count = LED_STRIP_CHUNK_PIXELS;
+                }
+                pattern->pixels(pattern->ctx, led_encoder->next_pixel, count, led_encoder->chunk);
+                led_encoder->next_pixel += count;
+                led_encoder->chunk_size = count * LED_STRIP_PIXEL_BYTES;
+            }
+            session_state = RMT_ENCODING_RESET;
+            encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, led_encoder->chunk, led_encoder->chunk_size, &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                led_encoder->chunk_size = 0; // generate the next chunk
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space for encoding artifacts
+            }
+        }
+        led_encoder->state = 1; // switch to next state when all the pixels are sent
+    // fall-through
     case 1: // send reset code
         encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
                                                 sizeof(led_encoder->reset_code), &session_state);
         if (session_state & RMT_ENCODING_COMPLETE) {
             led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            led_encoder->next_pixel = 0;
             state |= RMT_ENCODING_COMPLETE;
         }
         if (session_state & RMT_ENCODING_MEM_FULL) {
@@ -70,19 +148,22 @@ static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
     rmt_encoder_reset(led_encoder->bytes_encoder);
     rmt_encoder_reset(led_encoder->copy_encoder);
     led_encoder->state = RMT_ENCODING_RESET;
+    led_encoder->next_pixel = 0;
+    led_encoder->chunk_size = 0;
     return ESP_OK;
 }
 
-esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+static esp_err_t new_led_strip_encoder(const led_strip_encoder_config_t *config, const rmt_encoder_t *base, rmt_encoder_handle_t *ret_encoder)
 {
     esp_err_t ret = ESP_OK;
     rmt_led_strip_encoder_t *led_encoder = NULL;
     ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
     led_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_strip_encoder_t));
     ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    led_encoder->base = *base;
+    led_encoder->state = RMT_ENCODING_RESET;
+    led_encoder->next_pixel = 0;
+    led_encoder->chunk_size = 0;
     // different led strip might have its own timing requirements, following parameter is for WS2812
     rmt_bytes_encoder_config_t bytes_encoder_config = {
         .bit0 = {
@@ -124,3 +205,23 @@ err:
     }
     return ret;
 }
+
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    rmt_encoder_t base = {
+        .encode = rmt_encode_led_strip,
+        .reset = rmt_led_strip_encoder_reset,
+        .del = rmt_del_led_strip_encoder,
+    };
+    return new_led_strip_encoder(config, &base, ret_encoder);
+}
+
+esp_err_t rmt_new_led_strip_pattern_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    rmt_encoder_t base = {
+        .encode = rmt_encode_led_strip_pattern,
+        .reset = rmt_led_strip_encoder_reset,
+        .del = rmt_del_led_strip_encoder,
+    };
+    return new_led_strip_encoder(config, &base, ret_encoder);
+}
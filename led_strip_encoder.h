@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "driver/rmt_encoder.h"
 
@@ -19,9 +20,51 @@ typedef struct {
     uint32_t resolution; /*!< Encoder resolution, in Hz */
 } led_strip_encoder_config_t;
 
+/**
+ * @brief Pixels data to transmit, passed to rmt_transmit() as payload
+ *
+ * Pixels are sent as two contiguous spans one after another, so circular
+ * buffer can be sent as is, starting from any position, without copying.
+ * Both this structure and spans must stay valid until transmission is done,
+ * the second span may be empty.
+ */
+typedef struct {
+    const void *first;      /*!< The first span data */
+    size_t first_size;      /*!< The first span size, in bytes */
+    const void *second;     /*!< The second span data, sent right after the first one */
+    size_t second_size;     /*!< The second span size, in bytes, may be 0 */
+} led_strip_spans_t;
+
+/**
+ * @brief Pixels generator, fills strip data of consecutive pixels
+ *
+ * @note Called from RMT interrupt handler while symbols are encoded,
+ *       so it must be short, ISR safe and must not use floating point
+ *
+ * @param[in] ctx Generator context, see led_strip_pattern_t
+ * @param[in] first Index of the first pixel to generate
+ * @param[in] count Pixels count to generate
+ * @param[out] grb Generated pixels, count * 3 bytes in strip order (G, R, B)
+ */
+typedef void (*led_strip_pixels_cb_t)(const void *ctx, size_t first, size_t count, uint8_t *grb);
+
+/**
+ * @brief Generated pixels to transmit, passed to rmt_transmit() as payload for pattern encoder
+ *
+ * Pixels are produced by callback while RMT symbol memory is filled, no frame buffer is needed.
+ * Both this structure and generator context must stay valid until transmission is done.
+ */
+typedef struct {
+    led_strip_pixels_cb_t pixels;   /*!< Pixels generator */
+    const void *ctx;                /*!< Generator context, e.g. pattern description */
+    size_t count;                   /*!< Pixels count */
+} led_strip_pattern_t;
+
 /**
  * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
  *
+ * @note Encoder payload is led_strip_spans_t, not the pixels data itself
+ *
  * @param[in] config Encoder configuration
  * @param[out] ret_encoder Returned encoder handle
  * @return
@@ -31,6 +74,20 @@ typedef struct {
  */
 esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
 
+/**
+ * @brief Create RMT encoder for encoding generated LED strip pixels into RMT symbols
+ *
+ * @note Encoder payload is led_strip_pattern_t, pixels are generated by chunks while encoding
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating led strip encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_led_strip_pattern_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "multirate.h"
+
+#include <math.h>
+#include <string.h>
+
+// input is decimated by blocks of this size, on stack
+#define PUSH_BLOCK_SAMPLES  256
+
+void multirate_bass_init(struct multirate_bass* b, int16_t* history, size_t ns)
+{
+  for (int s = 0; s < MULTIRATE_STAGES; s++)
+    half_band_init(&b->stages[s]);
+  b->history = history;
+  b->ns = ns;
+  memset(history, 0, ns * sizeof(int16_t));
+}
+
+// appends n samples to history, dropping the oldest ones
+static void history_append(struct multirate_bass* b, const int16_t* x, size_t n)
+{
+  if (n >= b->ns) {
+    memcpy(b->history, x + n - b->ns, b->ns * sizeof(int16_t));
+    return;
+  }
+  memmove(b->history, b->history + n, (b->ns - n) * sizeof(int16_t));
+  memcpy(b->history + b->ns - n, x, n * sizeof(int16_t));
+}
+
+void multirate_bass_push(struct multirate_bass* b, const int16_t* input, size_t n)
+{
+  int16_t buf[PUSH_BLOCK_SAMPLES];
+
+  while (n > 0) {
+    const size_t m = n < PUSH_BLOCK_SAMPLES ? n : PUSH_BLOCK_SAMPLES;
+    size_t k = half_band_decimate(&b->stages[0], input, m, buf);
+    // the next stages work in-place
+    for (int s = 1; s < MULTIRATE_STAGES; s++)
+      k = half_band_decimate(&b->stages[s], buf, k, buf);
+    history_append(b, buf, k);
+    input += m;
+    n -= m;
+  }
+}
+
+// the first spectrum index with frequency not below hz, up to nfft,
+// spectrum index i is FFT bin i+1, see frequencies_data()
+static size_t first_index(float hz, size_t sample_rate, size_t nfft)
+{
+  const float bin = ceilf(hz * 2 * nfft / sample_rate);
+  const size_t i = bin > 1 ? (size_t)bin - 1 : 0;
+  return i < nfft ? i : nfft;
+}
+
+void multirate_layout_init(struct multirate_layout* l, float crossover_hz,
+                           size_t bass_rate, size_t bass_nfft,
+                           size_t main_rate, size_t main_nfft)
+{
+  l->bass_rate = bass_rate;
+  l->bass_nfft = bass_nfft;
+  l->main_rate = main_rate;
+  l->main_nfft = main_nfft;
+  l->split = first_index(crossover_hz, bass_rate, bass_nfft);
+  l->main_first = first_index(crossover_hz, main_rate, main_nfft);
+  l->count = l->split + main_nfft - l->main_first;
+}
+
+size_t multirate_index(const struct multirate_layout* l, float hz)
+{
+  const size_t b = first_index(hz, l->bass_rate, l->bass_nfft);
+  if (b < l->split)
+    return b;
+
+  size_t m = first_index(hz, l->main_rate, l->main_nfft);
+  if (m < l->main_first)
+    m = l->main_first;
+  return l->split + m - l->main_first;
+}
+
+void multirate_merge(const struct multirate_layout* l, const float* bass,
+                     float* spectrum)
+{
+  memmove(spectrum + 2*l->split, spectrum + 2*l->main_first,
+          2*(l->main_nfft - l->main_first) * sizeof(float));
+  memcpy(spectrum, bass, 2*l->split * sizeof(float));
+}
+
+void multirate_bands_log(const struct multirate_layout* l,
+                         struct spectrum_bands* bands, uint8_t count,
+                         float f_min, float f_max)
+{
+  if (count > MAX_SPECTRUM_BANDS)
+    count = MAX_SPECTRUM_BANDS;
+
+  // the same rules as spectrum_bands_hz() has
+  bands->count = count;
+  for (uint8_t i = 0; i <= count; i++) {
+    const float hz = f_min * powf(f_max / f_min, count ? (float)i / count : 0);
+    size_t e = multirate_index(l, hz);
+    if (i > 0 && e <= bands->edges[i-1])
+      e = bands->edges[i-1] + 1;
+    bands->edges[i] = e < l->count ? e : l->count;
+  }
+}
+
+// the first merged index within main spectrum index i, main bin
+// covers frequencies from the middle between it and the previous one
+static size_t main_bin_first(const struct multirate_layout* l, size_t i)
+{
+  return multirate_index(l, l->main_rate / 2.f * (i + 0.5f) / l->main_nfft);
+}
+
+static uint16_t map_first(const struct multirate_layout* l, uint16_t i)
+{
+  return main_bin_first(l, i);
+}
+
+static uint16_t map_last(const struct multirate_layout* l, uint16_t i)
+{
+  return main_bin_first(l, i + 1) - 1;
+}
+
+void multirate_lmh_bands(const struct multirate_layout* l, uint16_t bands[6],
+                         const struct filter_opt* opt)
+{
+  // main spectrum bands, limited to it the same way
+  uint16_t main[6];
+  spectrum_lmh_bands(main, opt, l->main_nfft);
+
+  bands[0] = 0;
+  bands[1] = map_last(l, main[1]);
+  bands[2] = map_first(l, main[2]);
+  bands[3] = map_last(l, main[3]);
+  bands[4] = map_first(l, main[4]);
+  bands[5] = l->count - 1;
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _MULTIRATE_H_
+#define _MULTIRATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio_ingest.h"
+#include "filter.h"
+
+// multirate analysis: bass region comes from the second, small FFT
+// of decimated input, which gives much finer bins for the same block
+// size, everything else comes from the usual full-rate FFT, both
+// spectra are merged into one with common frequency axis, so bands,
+// filterbanks and spectrum_bars() work with it as with usual one
+
+// bass branch decimation stages, each one halves sample rate
+#define MULTIRATE_STAGES      3
+#define MULTIRATE_DECIMATION  (1 << MULTIRATE_STAGES)
+
+// bass branch input, decimates analysis input (mono) as it arrives
+// and keeps the latest decimated samples, i.e. bass analysis block
+struct multirate_bass {
+  struct half_band_decimator stages[MULTIRATE_STAGES];
+  int16_t* history;   // the latest ns samples, in time order
+  size_t ns;
+};
+
+// resets state, history is filled with silence
+// history - buffer for decimated samples, ns in total
+void multirate_bass_init(struct multirate_bass* b, int16_t* history, size_t ns);
+
+// decimates chunk of analysis input and appends it to history
+// input - mono samples, n in total, any chunk size
+void multirate_bass_push(struct multirate_bass* b, const int16_t* input, size_t n);
+
+// merged spectrum layout: bass spectrum indexes below crossover,
+// then full-rate (main) spectrum indexes from crossover and above
+struct multirate_layout {
+  size_t bass_rate;     // bass branch sample rate
+  size_t bass_nfft;     // bass FFTs count
+  size_t main_rate;     // full-rate analysis sample rate
+  size_t main_nfft;     // full-rate FFTs count
+  uint16_t split;       // bass indexes count, i.e. the first main one
+  uint16_t main_first;  // main spectrum index at split
+  uint16_t count;       // merged spectrum elements count
+};
+
+// builds layout, done once per sample rate and FFT sizes
+// crossover_hz - the lowest frequency taken from main spectrum,
+// must be below bass branch Nyquist frequency
+void multirate_layout_init(struct multirate_layout* l, float crossover_hz,
+                           size_t bass_rate, size_t bass_nfft,
+                           size_t main_rate, size_t main_nfft);
+
+// the first merged spectrum index with frequency not below hz,
+// the same rule as spectrum_bands_hz() uses, up to l->count
+size_t multirate_index(const struct multirate_layout* l, float hz);
+
+// merges spectra, both are (freq,magnitude) pairs from analysis
+// bass - bass spectrum, bass_nfft pairs
+// spectrum - main spectrum, main_nfft pairs, it is **overwritten**
+//            by merged one, count pairs, must have room for them
+void multirate_merge(const struct multirate_layout* l, const float* bass,
+                     float* spectrum);
+
+// the same as spectrum_bands_log(), but for merged spectrum
+void multirate_bands_log(const struct multirate_layout* l,
+                         struct spectrum_bands* bands, uint8_t count,
+                         float f_min, float f_max);
+
+// the same as spectrum_lmh_bands(), but for merged spectrum: opt
+// thresholds are main spectrum indexes, each band covers the same
+// frequencies as with main spectrum, but with finer bins below
+// crossover, merged indexes may be above 255
+void multirate_lmh_bands(const struct multirate_layout* l, uint16_t bands[6],
+                         const struct filter_opt* opt);
+
+#endif /* _MULTIRATE_H_ */
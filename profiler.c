@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// clock_gettime() for host builds
+#define _POSIX_C_SOURCE 199309L
+
+#include "profiler.h"
+
+// nothing is built when profiler is off
+#if PROFILER_ENABLED
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define load_relaxed(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+
+// each stage (and frame stats) has the only writer, reset request
+// just bumps generation, writer clears its stats when it sees new one
+static uint32_t generation;
+
+struct stage_state {
+  uint32_t frame_ticks;   // current frame time, not committed yet
+  uint32_t gen;
+  struct profiler_stage_stats stats;
+};
+
+static struct stage_state stages[PROFILER_STAGES_COUNT];
+
+static struct {
+  uint32_t gen;
+  struct profiler_frame_stats stats;
+} frames;
+
+static const char* const stage_names[PROFILER_STAGES_COUNT] = {
+  "wait",
+  "prepare",
+  "fft",
+  "spectrum",
+  "bands",
+  "pwm",
+  "rmt",
+};
+
+#if !defined(ESP_PLATFORM)
+uint32_t profiler_ticks(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+#endif
+
+static unsigned bucket_index(uint32_t us)
+{
+  unsigned i = 0;
+  while (us > 0 && i < PROFILER_BUCKETS - 1) {
+    us >>= 1;
+    i++;
+  }
+  return i;
+}
+
+void profiler_add(enum profiler_stage stage, uint32_t ticks)
+{
+  stages[stage].frame_ticks += ticks;
+}
+
+// converts and records stage time of the current frame, returns it
+static uint32_t commit_stage(struct stage_state* s, uint32_t gen,
+                             uint32_t ticks_per_us)
+{
+  if (s->gen != gen) {
+    memset(&s->stats, 0, sizeof(s->stats));
+    s->gen = gen;
+  }
+
+  const uint32_t us = s->frame_ticks / ticks_per_us;
+  s->frame_ticks = 0;
+
+  struct profiler_stage_stats* st = &s->stats;
+  st->count++;
+  st->total_us += us;
+  if (us > st->max_us)
+    st->max_us = us;
+  st->hist[bucket_index(us)]++;
+  return us;
+}
+
+void profiler_commit(enum profiler_stage first, enum profiler_stage last)
+{
+  const uint32_t gen = load_relaxed(&generation);
+  const uint32_t ticks_per_us = profiler_ticks_per_us();
+  for (int i = first; i <= (int)last; i++)
+    commit_stage(&stages[i], gen, ticks_per_us);
+}
+
+void profiler_frame_end(uint32_t period_us)
+{
+  const uint32_t gen = load_relaxed(&generation);
+  const uint32_t ticks_per_us = profiler_ticks_per_us();
+
+  uint32_t busy_us = 0;
+  for (int i = PROFILER_ANALYSIS_FIRST; i <= PROFILER_ANALYSIS_LAST; i++) {
+    const uint32_t us = commit_stage(&stages[i], gen, ticks_per_us);
+    if (i != PROFILER_INGEST_WAIT)
+      busy_us += us;
+  }
+
+  if (frames.gen != gen) {
+    memset(&frames.stats, 0, sizeof(frames.stats));
+    frames.gen = gen;
+  }
+
+  frames.stats.frames++;
+  if (busy_us > period_us)
+    frames.stats.misses++;
+  if (busy_us > frames.stats.max_busy_us)
+    frames.stats.max_busy_us = busy_us;
+}
+
+void profiler_reset(void)
+{
+  __atomic_fetch_add(&generation, 1, __ATOMIC_RELAXED);
+}
+
+void profiler_stage_get(enum profiler_stage stage, struct profiler_stage_stats* out)
+{
+  const struct stage_state* s = &stages[stage];
+  // reset is requested, but not done yet
+  if (load_relaxed(&s->gen) != load_relaxed(&generation)) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = s->stats;
+}
+
+void profiler_frame_get(struct profiler_frame_stats* out)
+{
+  if (load_relaxed(&frames.gen) != load_relaxed(&generation)) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = frames.stats;
+}
+
+// snprintf() which appends to buffer and never goes beyond it
+#define report_append(...) do {                                 \
+    const int r_ = len < size ?                                 \
+      snprintf(buf + len, size - len, __VA_ARGS__) :            \
+      snprintf(NULL, 0, __VA_ARGS__);                           \
+    if (r_ > 0)                                                 \
+      len += r_;                                                \
+  } while (0)
+
+size_t profiler_report(char* buf, size_t size, bool histograms)
+{
+  size_t len = 0;
+
+  if (size > 0)
+    buf[0] = '\0';
+
+  report_append("stage count avg_us max_us\n");
+  for (int i = 0; i < PROFILER_STAGES_COUNT; i++) {
+    struct profiler_stage_stats st;
+    profiler_stage_get((enum profiler_stage)i, &st);
+    const uint32_t avg = st.count ? (uint32_t)(st.total_us / st.count) : 0;
+    report_append("%s %lu %lu %lu\n", stage_names[i], (unsigned long)st.count,
+                  (unsigned long)avg, (unsigned long)st.max_us);
+  }
+
+  struct profiler_frame_stats fs;
+  profiler_frame_get(&fs);
+  report_append("frames %lu misses %lu max_busy_us %lu\n",
+                (unsigned long)fs.frames, (unsigned long)fs.misses,
+                (unsigned long)fs.max_busy_us);
+
+  if (histograms) {
+    report_append("histograms, log2 us buckets\n");
+    for (int i = 0; i < PROFILER_STAGES_COUNT; i++) {
+      struct profiler_stage_stats st;
+      profiler_stage_get((enum profiler_stage)i, &st);
+      report_append("%s", stage_names[i]);
+      for (int b = 0; b < PROFILER_BUCKETS; b++)
+        report_append(" %lu", (unsigned long)st.hist[b]);
+      report_append("\n");
+    }
+  }
+
+  return len < size ? len : (size > 0 ? size - 1 : 0);
+}
+
+#endif /* PROFILER_ENABLED */
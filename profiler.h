@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// per-stage timings of the frame path, build-time switch, when it is
+// off all the PROFILER_*() macros below are empty and the rest of
+// the API is not used by the project code
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED  0
+#endif
+
+// timed stages, analysis ones are summed per analyzed frame
+// (e.g. prepare is done for each input chunk), output ones are
+// recorded per LEDs refresh
+enum profiler_stage {
+  PROFILER_INGEST_WAIT,   // waiting for audio, not a part of frame time
+  PROFILER_PREPARE,       // windowing, input layout, decimation
+  PROFILER_FFT,
+  PROFILER_SPECTRUM,      // magnitudes, weighting is applied here too
+  PROFILER_BANDS,         // 3-band and analyzer bands levels
+  PROFILER_PWM,
+  PROFILER_RMT,           // transmission start, it is asynchronous
+  PROFILER_STAGES_COUNT
+};
+
+#define PROFILER_ANALYSIS_FIRST   PROFILER_INGEST_WAIT
+#define PROFILER_ANALYSIS_LAST    PROFILER_BANDS
+#define PROFILER_OUTPUT_FIRST     PROFILER_PWM
+#define PROFILER_OUTPUT_LAST      PROFILER_RMT
+
+// histogram bucket 0 is below 1 us, bucket i is [2^(i-1), 2^i) us,
+// the last one has everything above
+#define PROFILER_BUCKETS  16
+
+struct profiler_stage_stats {
+  uint32_t count;       // frames (or refreshes) with this stage
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t hist[PROFILER_BUCKETS];
+};
+
+struct profiler_frame_stats {
+  uint32_t frames;      // analyzed frames
+  uint32_t misses;      // frames took longer than audio they analyze
+  uint32_t max_busy_us; // the longest frame, without waiting for audio
+};
+
+// time source: CPU cycle counter on ESP32, monotonic clock elsewhere,
+// 32 bits are enough for intervals, wrap around is fine
+#if defined(ESP_PLATFORM)
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+static inline uint32_t profiler_ticks(void)
+{
+  return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+static inline uint32_t profiler_ticks_per_us(void)
+{
+  return esp_rom_get_cpu_ticks_per_us();
+}
+#else
+// nanoseconds, see profiler.c
+uint32_t profiler_ticks(void);
+
+static inline uint32_t profiler_ticks_per_us(void)
+{
+  return 1000;
+}
+#endif
+
+// adds ticks to stage time of the current frame, each stage
+// must be recorded by the same task all the time
+void profiler_add(enum profiler_stage stage, uint32_t ticks);
+
+// moves current frame times of stages [first, last] to their stats
+void profiler_commit(enum profiler_stage first, enum profiler_stage last);
+
+// commits analysis stages, frame misses deadline if its busy time
+// (all analysis stages except waiting) is longer than period_us,
+// i.e. audio analyzed frame brings (hop size)
+void profiler_frame_end(uint32_t period_us);
+
+// requests stats reset, any task, done by stats writers
+void profiler_reset(void);
+
+// stats snapshot, may be a bit inconsistent while frames are recorded
+void profiler_stage_get(enum profiler_stage stage, struct profiler_stage_stats* out);
+void profiler_frame_get(struct profiler_frame_stats* out);
+
+// text report: stage, count, average and max time, then frame stats,
+// histograms are optional, they make it several times longer
+// returns report length, it is truncated to size - 1 if necessary
+size_t profiler_report(char* buf, size_t size, bool histograms);
+
+// hooks for the frame path, t is local ticks variable, lap records
+// time since start (or previous lap) for stage
+#if PROFILER_ENABLED
+#define PROFILER_START(t)       uint32_t t = profiler_ticks()
+#define PROFILER_LAP(t, stage)  do {                      \
+    const uint32_t now_ = profiler_ticks();               \
+    profiler_add((stage), now_ - (t));                    \
+    (t) = now_;                                           \
+  } while (0)
+#define PROFILER_FRAME_END(period_us)   profiler_frame_end(period_us)
+#define PROFILER_OUTPUT_END() \
+  profiler_commit(PROFILER_OUTPUT_FIRST, PROFILER_OUTPUT_LAST)
+#else
+#define PROFILER_START(t)               do {} while (0)
+#define PROFILER_LAP(t, stage)          do {} while (0)
+#define PROFILER_FRAME_END(period_us)   do {} while (0)
+#define PROFILER_OUTPUT_END()           do {} while (0)
+#endif
+
+#endif /* _PROFILER_H_ */
@@ -6,7 +6,21 @@
 #include <complex.h>
 #include <math.h>
 
-void fft_init(simple_fft_cfg* cfg, float* tw, unsigned int N)
+// fills bit-reversal permutation table, the same as rearrange() does
+static void bitrev_init(uint16_t* br, const unsigned int N)
+{
+  unsigned int target = 0;
+  for (unsigned int position = 0; position < N; position++) {
+    br[position] = target;
+
+    unsigned int mask = N;
+    while(target & (mask >>=1))
+      target &= ~mask;
+    target |= mask;
+  }
+}
+
+void fft_init(simple_fft_cfg* cfg, float* tw, uint16_t* br, unsigned int N)
 {
   cfg->n = N;
 
@@ -22,6 +36,10 @@ void fft_init(simple_fft_cfg* cfg, float* tw, unsigned int N)
   const float half_phi_inc = -pi / N;
   cfg->tw_mul_re = cosf(half_phi_inc);
   cfg->tw_mul_im = sinf(half_phi_inc);
+
+  if (br)
+    bitrev_init(br, N);
+  cfg->br = br;
 }
 
 static void rearrange(float complex* data, const unsigned int N)
@@ -41,39 +59,111 @@ static void rearrange(float complex* data, const unsigned int N)
   }
 }
 
+// the same as rearrange(), but uses precomputed permutation
+static void rearrange_table(float complex* data, const uint16_t* br,
+                            const unsigned int N)
+{
+  for (unsigned int position = 0; position < N; position++) {
+    const unsigned int target = br[position];
+    if (target > position) {
+      const float complex temp = data[target];
+      data[target] = data[position];
+      data[position] = temp;
+    }
+  }
+}
+
+// complex multiplication, written explicitly to avoid
+// the slow library call that handles inf/nan cases
+static inline float complex cmul(float complex a, float complex b)
+{
+  return (crealf(a)*crealf(b) - cimagf(a)*cimagf(b)) +
+         (crealf(a)*cimagf(b) + cimagf(a)*crealf(b))*I;
+}
+
+// multiplication by -i, i.e. rotation by -pi/2
+static inline float complex cmul_neg_i(float complex a)
+{
+  return cimagf(a) - crealf(a)*I;
+}
+
+// radix-4 butterfly, merges 4 sub-transforms of size s into one
+// p - points to the g-th element of the first sub-transform
+// t1, t2, t3 - g-th elements of the sub-transforms for samples
+// 4m+1, 4m+2 and 4m+3 respectively, already multiplied by twiddles
+static inline void butterfly4(float complex* p, const unsigned int s,
+                              const float complex t1,
+                              const float complex t2,
+                              const float complex t3)
+{
+  const float complex t0 = p[0];
+  const float complex s02 = t0 + t2;
+  const float complex d02 = t0 - t2;
+  const float complex s13 = t1 + t3;
+  const float complex d13 = cmul_neg_i(t1 - t3);
+  p[0*s] = s02 + s13;
+  p[1*s] = d02 + d13;
+  p[2*s] = s02 - s13;
+  p[3*s] = d02 - d13;
+}
+
 // does FFT, data must be processed by rearrange() before calling this
-// the code is based on https://github.com/lloydroc/arduino_fft
+// radix-4 decimation in time, with one radix-2 pass if log2(N) is odd
+// data is in radix-2 bit-reversed order, so sub-transforms of samples
+// 4m+1 and 4m+2 are swapped, i.e. at offsets 2s and s respectively
 static void compute(float complex* data, const float* tw, const unsigned int N)
 {
-  for (unsigned int step = 1; step < N; step <<= 1) {
-    const unsigned int jump = step << 1;
-    float twiddle_re = 1.f;
-    float twiddle_im = 0.f;
-    for (unsigned int group = 0; group < step; group++) {
-      for (unsigned int pair = group; pair < N; pair += jump) {
-        const unsigned int match = pair + step;
-        const float complex product =
-          (twiddle_re*crealf(data[match])-twiddle_im*cimagf(data[match])) +
-          (twiddle_im*crealf(data[match])+twiddle_re*cimagf(data[match]))*I;
-        data[match] = data[pair] - product;
-        data[pair] += product;
-      }
+  const float complex* twiddles = (const float complex*)tw;
+  unsigned int step = 1;
+
+  // N is not a power of 4, the first pass is radix-2,
+  // all its twiddle factors are 1, so no multiplications
+  if ((N & 0x55555555u) == 0) {
+    for (unsigned int pair = 0; pair < N; pair += 2) {
+      const float complex t = data[pair+1];
+      data[pair+1] = data[pair] - t;
+      data[pair] += t;
+    }
+    step = 2;
+  }
 
-      // we need the factors below for the next iteration
-      // if we don't iterate, then don't compute
-      if(group+1 == step)
-        continue;
+  for (; step < N; step <<= 2) {
+    const unsigned int jump = step << 2;
+    const unsigned int tw_inc = N / jump;
 
-      const unsigned int tw_idx = N/2 * (group+1)/step;
-      twiddle_re = tw[2*tw_idx+0];
-      twiddle_im = tw[2*tw_idx+1];
+    // the first group has all twiddle factors equal to 1
+    for (unsigned int i = 0; i < N; i += jump) {
+      float complex* p = data + i;
+      butterfly4(p, step, p[2*step], p[step], p[3*step]);
+    }
+
+    for (unsigned int group = 1; group < step; group++) {
+      const unsigned int tw_idx = group * tw_inc;
+      const float complex w1 = twiddles[1*tw_idx];
+      const float complex w2 = twiddles[2*tw_idx];
+      const float complex w3 = twiddles[3*tw_idx];
+      for (unsigned int i = group; i < N; i += jump) {
+        float complex* p = data + i;
+        butterfly4(p, step,
+                   cmul(w1, p[2*step]),
+                   cmul(w2, p[1*step]),
+                   cmul(w3, p[3*step]));
+      }
     }
   }
 }
 
 void fft_cplx(const simple_fft_cfg* cfg, float* data)
 {
-  rearrange((float complex*)data, cfg->n);
+  if (cfg->br)
+    rearrange_table((float complex*)data, cfg->br, cfg->n);
+  else
+    rearrange((float complex*)data, cfg->n);
+  compute((float complex*)data, cfg->tw, cfg->n);
+}
+
+void fft_cplx_bitrev(const simple_fft_cfg* cfg, float* data)
+{
   compute((float complex*)data, cfg->tw, cfg->n);
 }
 
@@ -98,9 +188,9 @@ static void postprocess(const simple_fft_cfg* cfg, float complex* dst)
                               (crealf(-dst[k]) + crealf(dst[N-k]))*I);
     const float complex twiddle = k % 2 == 0 ?
                                   twiddles[k/2] :
-                                  twiddles[k/2] * twiddle_mul;
-    dst[  k] =       w + twiddle * z;
-    dst[N-k] = conjf(w - twiddle * z);
+                                  cmul(twiddles[k/2], twiddle_mul);
+    dst[  k] =       w + cmul(twiddle, z);
+    dst[N-k] = conjf(w - cmul(twiddle, z));
   }
   if (N % 2 == 0)
     dst[N/2] = conjf(dst[N/2]);
@@ -111,3 +201,9 @@ void fft_real(const simple_fft_cfg* cfg, float* data)
   fft_cplx(cfg, data);
   postprocess(cfg, (float complex*)data);
 }
+
+void fft_real_bitrev(const simple_fft_cfg* cfg, float* data)
+{
+  fft_cplx_bitrev(cfg, data);
+  postprocess(cfg, (float complex*)data);
+}
@@ -4,6 +4,8 @@
 #ifndef SIMPLE_FFT_H
 #define SIMPLE_FFT_H
 
+#include <stdint.h>
+
 // FFT configuration / service data struct
 // this struct was intentionally made a part of the interface
 // to allow compile-time initialization with static data
@@ -12,6 +14,7 @@ typedef struct {
   const float* tw;    // twiddle factors, 2n (n *pairs*)
   float tw_mul_re;    // real and imaginary parts of the
   float tw_mul_im;    // special value used for real FFT
+  const uint16_t* br; // bit-reversal permutation, n values, optional
 } simple_fft_cfg;
 
 // initializes all the fields in configuration struct
@@ -21,10 +24,12 @@ typedef struct {
 // the static data previously returned by this function
 // cfg - simple_fft_cfg struct to fill
 // tw - buffer used for twiddle factors, 2*N values
+// br - buffer used for bit-reversal permutation, N values,
+// may be NULL, then permutation is computed on the fly
 // N - FFTs count, must be data buffer size / 2
 // function doesn't do any dynamic memory allocation,
 // pointer as argument directly used for field initialization
-void fft_init(simple_fft_cfg* cfg, float* tw, unsigned int N);
+void fft_init(simple_fft_cfg* cfg, float* tw, uint16_t* br, unsigned int N);
 
 // does in-place FFT transform
 // output format is the same as in KISS FFT C++
@@ -38,4 +43,12 @@ void fft_cplx(const simple_fft_cfg* cfg, float* data);
 // data is an array of real values, 2*N in total
 void fft_real(const simple_fft_cfg* cfg, float* data);
 
+// the same as fft_cplx() and fft_real(), but input data is
+// already in bit-reversed order, i.e. (re,im) pair i must be
+// at the position cfg->br[i], this saves one pass over data
+// when input is produced by some other pass anyway
+// output format is the same (in natural order)
+void fft_cplx_bitrev(const simple_fft_cfg* cfg, float* data);
+void fft_real_bitrev(const simple_fft_cfg* cfg, float* data);
+
 #endif  // SIMPLE_FFT_H
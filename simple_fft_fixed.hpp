@@ -0,0 +1,283 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: Unlicense OR CC0-1.0
+
+#ifndef SIMPLE_FFT_FIXED_HPP
+#define SIMPLE_FFT_FIXED_HPP
+
+#include <array>
+#include <complex>
+#include <cstdint>
+
+extern "C" {
+#include "simple_fft.h"
+#include "simple_fft_q15.h"
+}
+
+// compile-time variant of simple_fft for fixed FFT size (C++17)
+// all the tables are generated by the compiler and live in flash,
+// FFT kernels are specialized for the size, so all the passes are
+// unrolled and all the loop bounds and strides are constants
+// adding new size is just a reference to simple_fft_fixed<N>, e.g.
+//   const simple_fft_cfg* cfg = &simple_fft_fixed<512>::cfg;
+//   simple_fft_fixed<512>::fft_real_bitrev(cfg, data);
+// output is the same as simple_fft gives within float rounding
+
+namespace simple_fft_ct {
+
+constexpr double pi = 3.14159265358979323846;
+
+// sin(x) and cos(x) for |x| <= pi/4, Taylor series
+// terms up to x^23 are enough for double precision
+constexpr double sin_reduced(double x)
+{
+  const double x2 = x * x;
+  double term = x;
+  double sum = x;
+  for (int i = 1; i < 12; i++) {
+    term *= -x2 / ((2*i) * (2*i + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double cos_reduced(double x)
+{
+  const double x2 = x * x;
+  double term = 1;
+  double sum = 1;
+  for (int i = 1; i < 12; i++) {
+    term *= -x2 / ((2*i - 1) * (2*i));
+    sum += term;
+  }
+  return sum;
+}
+
+// cos(pi*num/den) and sin(pi*num/den), den > 0, angle is reduced
+// to [-pi/4, pi/4] exactly, in integers: pi/2*(2*num/den - q)
+struct sincos_t { double sin, cos; };
+
+constexpr sincos_t sincos_pi(long num, long den)
+{
+  const bool neg = num < 0;
+  if (neg) num = -num;
+  const long q = (4*num + den) / (2*den);   // round(2*num/den)
+  const double r = pi / 2 * (2*num - q*den) / den;
+  const double s = sin_reduced(r);
+  const double c = cos_reduced(r);
+  sincos_t v = {0, 0};
+  switch (q % 4) {
+    case 0: v = {s, c}; break;
+    case 1: v = {c, -s}; break;
+    case 2: v = {-s, -c}; break;
+    case 3: v = {-c, s}; break;
+  }
+  if (neg) v.sin = -v.sin;
+  return v;
+}
+
+// the same rounding as lround() does, saturated to 16 bits
+constexpr int16_t q15_from_double(double x)
+{
+  const double v = x * 32768;
+  long r = v < 0 ? -(long)(-v + 0.5) : (long)(v + 0.5);
+  if (r > INT16_MAX) r = INT16_MAX;
+  if (r < INT16_MIN) r = INT16_MIN;
+  return (int16_t)r;
+}
+
+}  // namespace simple_fft_ct
+
+template<unsigned int N>
+struct simple_fft_fixed {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be power of 2");
+  static_assert(N <= 65536, "bit-reversal table is 16 bit");
+
+  // twiddle factors, the same as fft_init() fills: exp(-2*pi*i*k/N)
+  static constexpr std::array<float, 2*N> make_twiddles()
+  {
+    std::array<float, 2*N> tw = {};
+    for (unsigned int k = 0; k < N; k++) {
+      const auto v = simple_fft_ct::sincos_pi(-2L*k, N);
+      tw[2*k+0] = (float)v.cos;
+      tw[2*k+1] = (float)v.sin;
+    }
+    return tw;
+  }
+
+  static constexpr std::array<int16_t, 2*N> make_twiddles_q15()
+  {
+    std::array<int16_t, 2*N> tw = {};
+    for (unsigned int k = 0; k < N; k++) {
+      const auto v = simple_fft_ct::sincos_pi(-2L*k, N);
+      tw[2*k+0] = simple_fft_ct::q15_from_double(v.cos);
+      tw[2*k+1] = simple_fft_ct::q15_from_double(v.sin);
+    }
+    return tw;
+  }
+
+  // real FFT post-processing twiddles exp(-pi*i*k/N), k < N/2,
+  // simple_fft derives odd ones at runtime, with one multiplication
+  static constexpr std::array<float, N> make_real_twiddles()
+  {
+    std::array<float, N> tw = {};
+    for (unsigned int k = 0; k < N/2; k++) {
+      const auto v = simple_fft_ct::sincos_pi(-(long)k, N);
+      tw[2*k+0] = (float)v.cos;
+      tw[2*k+1] = (float)v.sin;
+    }
+    return tw;
+  }
+
+  static constexpr std::array<uint16_t, N> make_bitrev()
+  {
+    std::array<uint16_t, N> br = {};
+    unsigned int target = 0;
+    for (unsigned int position = 0; position < N; position++) {
+      br[position] = target;
+
+      unsigned int mask = N;
+      while(target & (mask >>=1))
+        target &= ~mask;
+      target |= mask;
+    }
+    return br;
+  }
+
+  static constexpr std::array<float, 2*N> tw = make_twiddles();
+  static constexpr std::array<int16_t, 2*N> tw_q15 = make_twiddles_q15();
+  static constexpr std::array<float, N> tw_real = make_real_twiddles();
+  static constexpr std::array<uint16_t, N> br = make_bitrev();
+
+  // ready to use configurations, with bit-reversal table
+  static constexpr simple_fft_cfg cfg = {
+    N, tw.data(),
+    (float)simple_fft_ct::sincos_pi(-1, N).cos,
+    (float)simple_fft_ct::sincos_pi(-1, N).sin,
+    br.data(),
+  };
+
+  static constexpr simple_fft_q15_cfg cfg_q15 = {
+    N, tw_q15.data(),
+    simple_fft_ct::q15_from_double(simple_fft_ct::sincos_pi(-1, N).cos),
+    simple_fft_ct::q15_from_double(simple_fft_ct::sincos_pi(-1, N).sin),
+    br.data(),
+  };
+
+  // the same as fft_real_bitrev(), but doesn't use cfg at all,
+  // it is here only to match fft_real_bitrev() signature
+  static void fft_real_bitrev(const simple_fft_cfg* cfg, float* data)
+  {
+    (void)cfg;
+    auto* p = reinterpret_cast<std::complex<float>*>(data);
+    compute(p);
+    postprocess(p);
+  }
+
+  // the same as fft_cplx_bitrev()
+  static void fft_cplx_bitrev(const simple_fft_cfg* cfg, float* data)
+  {
+    (void)cfg;
+    compute(reinterpret_cast<std::complex<float>*>(data));
+  }
+
+private:
+  using cpx = std::complex<float>;
+
+  // explicit multiplications, see simple_fft.c
+  static inline cpx cmul(const cpx a, const cpx b)
+  {
+    return cpx(a.real()*b.real() - a.imag()*b.imag(),
+               a.real()*b.imag() + a.imag()*b.real());
+  }
+
+  static inline cpx cmul_neg_i(const cpx a)
+  {
+    return cpx(a.imag(), -a.real());
+  }
+
+  static inline cpx twiddle(unsigned int k)
+  {
+    return cpx(tw[2*k+0], tw[2*k+1]);
+  }
+
+  // radix-4 butterfly, the same as in simple_fft.c, S is pass step
+  template<unsigned int S>
+  static inline void butterfly4(cpx* p, const cpx t1, const cpx t2, const cpx t3)
+  {
+    const cpx t0 = p[0];
+    const cpx s02 = t0 + t2;
+    const cpx d02 = t0 - t2;
+    const cpx s13 = t1 + t3;
+    const cpx d13 = cmul_neg_i(t1 - t3);
+    p[0*S] = s02 + s13;
+    p[1*S] = d02 + d13;
+    p[2*S] = s02 - s13;
+    p[3*S] = d02 - d13;
+  }
+
+  // radix-4 pass with step S, then all the following passes
+  template<unsigned int S>
+  static inline void radix4_passes(cpx* data)
+  {
+    if constexpr (S < N) {
+      constexpr unsigned int jump = S << 2;
+      constexpr unsigned int tw_inc = N / jump;
+
+      for (unsigned int i = 0; i < N; i += jump) {
+        cpx* p = data + i;
+        butterfly4<S>(p, p[2*S], p[S], p[3*S]);
+      }
+
+      for (unsigned int group = 1; group < S; group++) {
+        const unsigned int tw_idx = group * tw_inc;
+        const cpx w1 = twiddle(1*tw_idx);
+        const cpx w2 = twiddle(2*tw_idx);
+        const cpx w3 = twiddle(3*tw_idx);
+        for (unsigned int i = group; i < N; i += jump) {
+          cpx* p = data + i;
+          butterfly4<S>(p,
+                        cmul(w1, p[2*S]),
+                        cmul(w2, p[1*S]),
+                        cmul(w3, p[3*S]));
+        }
+      }
+
+      radix4_passes<jump>(data);
+    }
+  }
+
+  // the same algorithm as compute() in simple_fft.c
+  static void compute(cpx* data)
+  {
+    if constexpr ((N & 0x55555555u) == 0) {
+      for (unsigned int pair = 0; pair < N; pair += 2) {
+        const cpx t = data[pair+1];
+        data[pair+1] = data[pair] - t;
+        data[pair] += t;
+      }
+      radix4_passes<2>(data);
+    } else {
+      radix4_passes<1>(data);
+    }
+  }
+
+  // the same as postprocess() in simple_fft.c, but with
+  // precomputed twiddles for all k
+  static void postprocess(cpx* dst)
+  {
+    dst[0] = cpx(dst[0].real() + dst[0].imag(), dst[0].real() - dst[0].imag());
+
+    for (unsigned int k = 1; 2*k < N; ++k ) {
+      const cpx w = 0.5f * cpx(dst[k].real() + dst[N-k].real(),
+                               dst[k].imag() - dst[N-k].imag());
+      const cpx z = 0.5f * cpx(dst[k].imag() + dst[N-k].imag(),
+                               dst[N-k].real() - dst[k].real());
+      const cpx tz = cmul(cpx(tw_real[2*k+0], tw_real[2*k+1]), z);
+      dst[  k] =           w + tz;
+      dst[N-k] = std::conj(w - tz);
+    }
+    dst[N/2] = std::conj(dst[N/2]);
+  }
+};
+
+#endif  // SIMPLE_FFT_FIXED_HPP
@@ -0,0 +1,322 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: Unlicense OR CC0-1.0
+
+#include "simple_fft_q15.h"
+
+#include <math.h>
+
+// worst case growth of component values per pass,
+// used to choose shift needed to avoid overflow
+#define GROWTH_RADIX2   2   // a + b
+#define GROWTH_RADIX4   6   // 4 * sqrt(2) rounded up
+#define GROWTH_REAL     3   // 1 + sqrt(2) rounded up
+
+static int16_t q15_from_float(float x)
+{
+  long v = lroundf(x * 32768.f);
+  if (v > INT16_MAX) v = INT16_MAX;
+  if (v < INT16_MIN) v = INT16_MIN;
+  return (int16_t)v;
+}
+
+void fft_init_q15(simple_fft_q15_cfg* cfg, int16_t* tw, uint16_t* br,
+                  unsigned int N)
+{
+  cfg->n = N;
+
+  const float pi = acosf(-1.f);
+  const float phinc = -2 * pi / N;
+  for (unsigned int i = 0; i < N; i++) {
+    tw[2*i+0] = q15_from_float(cosf(i*phinc));
+    tw[2*i+1] = q15_from_float(sinf(i*phinc));
+  }
+  cfg->tw = tw;
+
+  // special last item that used by real FFT
+  const float half_phi_inc = -pi / N;
+  cfg->tw_mul_re = q15_from_float(cosf(half_phi_inc));
+  cfg->tw_mul_im = q15_from_float(sinf(half_phi_inc));
+
+  // the same permutation as in float version
+  if (br) {
+    unsigned int target = 0;
+    for (unsigned int position = 0; position < N; position++) {
+      br[position] = target;
+
+      unsigned int mask = N;
+      while(target & (mask >>=1))
+        target &= ~mask;
+      target |= mask;
+    }
+  }
+  cfg->br = br;
+}
+
+static inline int32_t abs32(int32_t v)
+{
+  return v < 0 ? -v : v;
+}
+
+static inline int32_t max32(int32_t a, int32_t b)
+{
+  return a > b ? a : b;
+}
+
+// rounding arithmetic shift right, s may be 0
+static inline int32_t shr_round(int32_t v, unsigned int s)
+{
+  return (v + ((1 << s) >> 1)) >> s;
+}
+
+// Q15 multiplication with rounding
+static inline int32_t mul_q15(int32_t a, int32_t b)
+{
+  return (a * b + (1 << 14)) >> 15;
+}
+
+// number of bits to shift pass output right by, to fit it in 16 bits
+// max_abs - maximum absolute component value before the pass
+// growth - worst case growth of values in the pass
+static unsigned int pass_shift(int32_t max_abs, int32_t growth)
+{
+  const int32_t bound = max_abs * growth;
+  unsigned int s = 0;
+  while ((bound >> s) >= INT16_MAX)
+    s++;
+  return s;
+}
+
+// stores (re,im) pair shifted right by s, returns max absolute value of it
+static inline int32_t store(int16_t* p, int32_t re, int32_t im, unsigned int s)
+{
+  re = shr_round(re, s);
+  im = shr_round(im, s);
+  p[0] = (int16_t)re;
+  p[1] = (int16_t)im;
+  return max32(abs32(re), abs32(im));
+}
+
+static inline void swap_pairs(int16_t* data, unsigned int a, unsigned int b)
+{
+  const int16_t re = data[2*a+0];
+  const int16_t im = data[2*a+1];
+  data[2*a+0] = data[2*b+0];
+  data[2*a+1] = data[2*b+1];
+  data[2*b+0] = re;
+  data[2*b+1] = im;
+}
+
+// the same as in simple_fft.c, but also finds max absolute value
+// br - bit-reversal permutation table, may be NULL
+static int32_t rearrange(int16_t* data, const uint16_t* br,
+                         const unsigned int N)
+{
+  int32_t max_abs = 0;
+  unsigned int target = 0;
+  for (unsigned int position = 0; position < N; position++) {
+    if (br)
+      target = br[position];
+
+    if (target > position)
+      swap_pairs(data, target, position);
+
+    max_abs = max32(max_abs, abs32(data[2*position+0]));
+    max_abs = max32(max_abs, abs32(data[2*position+1]));
+
+    if (br)
+      continue;
+
+    unsigned int mask = N;
+    while(target & (mask >>=1))
+      target &= ~mask;
+    target |= mask;
+  }
+  return max_abs;
+}
+
+// radix-4 butterfly, see simple_fft.c for the details
+// p - points to the g-th (re,im) pair of the first sub-transform
+// s - sub-transform size, in (re,im) pairs
+// t1, t2, t3 - (re,im) of the samples 4m+1, 4m+2 and 4m+3 sub-transforms
+// shift - output shift, returns max absolute output value
+static inline int32_t butterfly4(int16_t* p, const unsigned int s,
+                                 const int32_t t1[2],
+                                 const int32_t t2[2],
+                                 const int32_t t3[2],
+                                 const unsigned int shift)
+{
+  const int32_t s02_re = p[0] + t2[0];
+  const int32_t s02_im = p[1] + t2[1];
+  const int32_t d02_re = p[0] - t2[0];
+  const int32_t d02_im = p[1] - t2[1];
+  const int32_t s13_re = t1[0] + t3[0];
+  const int32_t s13_im = t1[1] + t3[1];
+  // (t1 - t3) * -i
+  const int32_t d13_re = t1[1] - t3[1];
+  const int32_t d13_im = t3[0] - t1[0];
+
+  int32_t m = 0;
+  m = max32(m, store(p + 0*2*s, s02_re + s13_re, s02_im + s13_im, shift));
+  m = max32(m, store(p + 1*2*s, d02_re + d13_re, d02_im + d13_im, shift));
+  m = max32(m, store(p + 2*2*s, s02_re - s13_re, s02_im - s13_im, shift));
+  m = max32(m, store(p + 3*2*s, d02_re - d13_re, d02_im - d13_im, shift));
+  return m;
+}
+
+// loads (re,im) pair from p multiplied by twiddle w
+static inline void load_mul(int32_t t[2], const int16_t* p, const int16_t* w)
+{
+  t[0] = mul_q15(p[0], w[0]) - mul_q15(p[1], w[1]);
+  t[1] = mul_q15(p[0], w[1]) + mul_q15(p[1], w[0]);
+}
+
+static inline void load(int32_t t[2], const int16_t* p)
+{
+  t[0] = p[0];
+  t[1] = p[1];
+}
+
+// the same algorithm as in simple_fft.c, with block floating point
+// max_abs - max absolute value in data, updated to the output one
+// returns total shift
+static int compute(int16_t* data, const int16_t* tw, const unsigned int N,
+                   int32_t* p_max_abs)
+{
+  int32_t max_abs = *p_max_abs;
+  int exponent = 0;
+  unsigned int step = 1;
+
+  if ((N & 0x55555555u) == 0) {
+    const unsigned int shift = pass_shift(max_abs, GROWTH_RADIX2);
+    max_abs = 0;
+    for (unsigned int pair = 0; pair < N; pair += 2) {
+      int16_t* p = data + 2*pair;
+      const int32_t a_re = p[0], a_im = p[1];
+      const int32_t b_re = p[2], b_im = p[3];
+      max_abs = max32(max_abs, store(p + 0, a_re + b_re, a_im + b_im, shift));
+      max_abs = max32(max_abs, store(p + 2, a_re - b_re, a_im - b_im, shift));
+    }
+    exponent += shift;
+    step = 2;
+  }
+
+  for (; step < N; step <<= 2) {
+    const unsigned int jump = step << 2;
+    const unsigned int tw_inc = N / jump;
+    const unsigned int shift = pass_shift(max_abs, GROWTH_RADIX4);
+    int32_t t1[2], t2[2], t3[2];
+
+    max_abs = 0;
+
+    for (unsigned int i = 0; i < N; i += jump) {
+      int16_t* p = data + 2*i;
+      load(t1, p + 2*2*step);
+      load(t2, p + 1*2*step);
+      load(t3, p + 3*2*step);
+      max_abs = max32(max_abs, butterfly4(p, step, t1, t2, t3, shift));
+    }
+
+    for (unsigned int group = 1; group < step; group++) {
+      const unsigned int tw_idx = group * tw_inc;
+      const int16_t* w1 = tw + 2*(1*tw_idx);
+      const int16_t* w2 = tw + 2*(2*tw_idx);
+      const int16_t* w3 = tw + 2*(3*tw_idx);
+      for (unsigned int i = group; i < N; i += jump) {
+        int16_t* p = data + 2*i;
+        load_mul(t1, p + 2*2*step, w1);
+        load_mul(t2, p + 1*2*step, w2);
+        load_mul(t3, p + 3*2*step, w3);
+        max_abs = max32(max_abs, butterfly4(p, step, t1, t2, t3, shift));
+      }
+    }
+
+    exponent += shift;
+  }
+
+  *p_max_abs = max_abs;
+  return exponent;
+}
+
+// rearranges data and does FFT, returns exponent
+// max_abs is max absolute value in the output
+static int fft_cplx_impl(const simple_fft_q15_cfg* cfg, int16_t* data,
+                         int32_t* max_abs)
+{
+  *max_abs = rearrange(data, cfg->br, cfg->n);
+  return compute(data, cfg->tw, cfg->n, max_abs);
+}
+
+int fft_cplx_q15(const simple_fft_q15_cfg* cfg, int16_t* data)
+{
+  int32_t max_abs;
+  return fft_cplx_impl(cfg, data, &max_abs);
+}
+
+int fft_cplx_q15_bitrev(const simple_fft_q15_cfg* cfg, int16_t* data,
+                        int32_t max_abs)
+{
+  return compute(data, cfg->tw, cfg->n, &max_abs);
+}
+
+// the same as in simple_fft.c, w and z are not halved,
+// the 0.5 factor is applied as part of the output shift
+static int postprocess(const simple_fft_q15_cfg* cfg, int16_t* dst,
+                       int32_t max_abs)
+{
+  const unsigned int N = cfg->n;
+  const unsigned int shift = pass_shift(max_abs, GROWTH_REAL);
+
+  // post-processing for k = 0 and k = N
+  const int32_t dc_re = dst[0];
+  const int32_t dc_im = dst[1];
+  store(dst, dc_re + dc_im, dc_re - dc_im, shift);
+
+  // post-processing for all the other k = 1, 2, ..., N-1
+  const int16_t* twiddles = cfg->tw;
+  const int16_t twiddle_mul[2] = {cfg->tw_mul_re, cfg->tw_mul_im};
+  for (unsigned int k = 1; 2*k < N; ++k ) {
+    int16_t* pk = dst + 2*k;
+    int16_t* pnk = dst + 2*(N-k);
+    const int32_t w_re = pk[0] + pnk[0];
+    const int32_t w_im = pk[1] - pnk[1];
+    const int32_t z_re = pk[1] + pnk[1];
+    const int32_t z_im = pnk[0] - pk[0];
+
+    int16_t twiddle[2];
+    if (k % 2 == 0) {
+      twiddle[0] = twiddles[k];
+      twiddle[1] = twiddles[k+1];
+    } else {
+      int32_t t[2];
+      load_mul(t, twiddles + 2*(k/2), twiddle_mul);
+      twiddle[0] = (int16_t)t[0];
+      twiddle[1] = (int16_t)t[1];
+    }
+
+    const int32_t tz_re = mul_q15(twiddle[0], z_re) - mul_q15(twiddle[1], z_im);
+    const int32_t tz_im = mul_q15(twiddle[0], z_im) + mul_q15(twiddle[1], z_re);
+
+    store(pk, w_re + tz_re, w_im + tz_im, shift + 1);
+    store(pnk, w_re - tz_re, tz_im - w_im, shift + 1);
+  }
+  if (N % 2 == 0) {
+    int16_t* p = dst + N;
+    store(p, p[0], -p[1], shift);
+  }
+
+  return shift;
+}
+
+int fft_real_q15(const simple_fft_q15_cfg* cfg, int16_t* data)
+{
+  int32_t max_abs;
+  int exponent = fft_cplx_impl(cfg, data, &max_abs);
+  return exponent + postprocess(cfg, data, max_abs);
+}
+
+int fft_real_q15_bitrev(const simple_fft_q15_cfg* cfg, int16_t* data,
+                        int32_t max_abs)
+{
+  int exponent = compute(data, cfg->tw, cfg->n, &max_abs);
+  return exponent + postprocess(cfg, data, max_abs);
+}
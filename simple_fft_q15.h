@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: Unlicense OR CC0-1.0
+
+#ifndef SIMPLE_FFT_Q15_H
+#define SIMPLE_FFT_Q15_H
+
+#include <stdint.h>
+
+// fixed-point (Q15) variant of simple_fft, see simple_fft.h
+// data is 16bit integers, block floating point scaling is used:
+// before every pass data is shifted right just enough to avoid
+// overflow, total shift is returned to the caller as exponent,
+// so real FFT output is (output * 2^exponent)
+
+// FFT configuration / service data struct
+// the same as simple_fft_cfg, but all values are Q15
+typedef struct {
+  unsigned int n;     // FFTs count, should be power of 2
+  const int16_t* tw;  // twiddle factors, 2n (n *pairs*)
+  int16_t tw_mul_re;  // real and imaginary parts of the
+  int16_t tw_mul_im;  // special value used for real FFT
+  const uint16_t* br; // bit-reversal permutation, n values, optional
+} simple_fft_q15_cfg;
+
+// initializes all the fields in configuration struct
+// cfg - simple_fft_q15_cfg struct to fill
+// tw - buffer used for twiddle factors, 2*N values
+// br - buffer used for bit-reversal permutation, N values, may be NULL
+// N - FFTs count, must be data buffer size / 2
+void fft_init_q15(simple_fft_q15_cfg* cfg, int16_t* tw, uint16_t* br,
+                  unsigned int N);
+
+// does in-place FFT transform
+// output format is the same as in KISS FFT C++
+// cfg - FFT configuration (see above)
+// data is an array of (re,im) pairs, N in total
+// returns exponent, number of bits output was shifted right by
+int fft_cplx_q15(const simple_fft_q15_cfg* cfg, int16_t* data);
+
+// does in-place FFT transform
+// output format is the same as in KISS FFT C++
+// cfg - FFT configuration (see above)
+// data is an array of real values, 2*N in total
+// returns exponent, number of bits output was shifted right by
+int fft_real_q15(const simple_fft_q15_cfg* cfg, int16_t* data);
+
+// the same as fft_cplx_q15() and fft_real_q15(), but input
+// data is already in bit-reversed order, see simple_fft.h
+// max_abs - max absolute value in data, caller usually knows it
+// as a side effect of producing the data
+int fft_cplx_q15_bitrev(const simple_fft_q15_cfg* cfg, int16_t* data,
+                        int32_t max_abs);
+int fft_real_q15_bitrev(const simple_fft_q15_cfg* cfg, int16_t* data,
+                        int32_t max_abs);
+
+#endif  // SIMPLE_FFT_Q15_H
@@ -5,6 +5,9 @@
 
 #include <tgmath.h>
 
+#include "fast_math.h"
+#include "profiler.h"
+
 void frequencies_data(float* freq, size_t sample_rate, size_t n)
 {
   for (size_t i = 0; i < n; i++) {
@@ -12,32 +15,142 @@ void frequencies_data(float* freq, size_t sample_rate, size_t n)
   }
 }
 
-// converts raw_input into the form expected by FFT algorithm
-// implementation depends on FFT algorithm input format
-// raw_input - 16bit stereo input, size must be 2*ns
-// input - output buffer where prepared data should be written
-// ns - samples count (i.e. number of *pairs* in raw_input)
-// raw_input size is 2*ns, window and input size is ns
-static void prepare_fft_input(const struct analysis_cfg* cfg,
-                              const int16_t* raw_input, float* input)
+// generalized cosine window coefficient, i.e. sum of a[k]*cos(k*x)
+// with alternating signs, where x changes from 0 to 2*pi
+static float window_coefficient(enum window_type type, size_t i, size_t ns)
 {
-  const size_t ns = 2*cfg->fft_cfg->n;
-  const float* window = cfg->kwnd;
-  const int16_t* raw_input_end = raw_input + 2*ns;        // 2 channels
-  for (; raw_input != raw_input_end; raw_input += 2) {
-    int16_t ch1 = *(raw_input+0);
-    int16_t ch2 = *(raw_input+1);
-    *input++ = (ch1 + ch2) / 2.f / 32768.f * cfg->preamp * *window++;
+  // symmetric windows, the same as the tables had
+  static const float hann[] = {0.5f, 0.5f};
+  static const float blackman_harris[] = {0.35875f, 0.48829f, 0.14128f, 0.01168f};
+  static const float flat_top[] = {
+    0.21557895f, 0.41663158f, 0.277263158f, 0.083578947f, 0.006947368f,
+  };
+
+  const float* a = hann;
+  size_t n = sizeof(hann) / sizeof(hann[0]);
+  switch (type) {
+    case WINDOW_BLACKMAN_HARRIS:
+      a = blackman_harris;
+      n = sizeof(blackman_harris) / sizeof(blackman_harris[0]);
+      break;
+    case WINDOW_FLAT_TOP:
+      a = flat_top;
+      n = sizeof(flat_top) / sizeof(flat_top[0]);
+      break;
+    default:
+      break;
+  }
+
+  const float pi = acos(-1.f);
+  const float x = 2 * pi * i / (ns - 1);
+  float w = 0;
+  for (size_t k = 0; k < n; k++)
+    w += (k % 2 ? -a[k] : a[k]) * cos(k * x);
+  return w;
+}
+
+float window_data(float* kwnd, size_t ns, enum window_type type,
+                  float* sq_sum)
+{
+  // one-time calculation, so precision is preferred
+  double sum = 0;
+  double sum2 = 0;
+  for (size_t i = 0; i < ns; i++) {
+    kwnd[i] = window_coefficient(type, i, ns);
+    sum += kwnd[i];
+    sum2 += kwnd[i] * kwnd[i];
   }
+  if (sq_sum)
+    *sq_sum = sum2;
+  return sum;
 }
 
-// process FFT output buffer and calculates spectrum
-// implementation depends on FFT algorithm output format
-// expected format the same as KISSFFT C++ produces for real data input
-// spectrum data **overwrites** FFT data, amplitudes are at odd indexes
-// fft_buffer - FFT algorithm output buffer, size must be 2*nfft
-static void calculate_spectrum(const struct analysis_cfg* cfg,
-                               float* fft_buffer)
+float window_data_q15(int16_t* kwnd, size_t ns, enum window_type type,
+                      float* sq_sum)
+{
+  double sum = 0;
+  double sum2 = 0;
+  for (size_t i = 0; i < ns; i++) {
+    long v = lround(window_coefficient(type, i, ns) * 32768);
+    kwnd[i] = (int16_t)(v > INT16_MAX ? INT16_MAX : v);
+    double k = kwnd[i] / 32768.;
+    sum += k;
+    sum2 += k * k;
+  }
+  if (sq_sum)
+    *sq_sum = sum2;
+  return sum;
+}
+
+// IEC 61672 A-weighting gain, linear
+static float a_weighting(float f)
+{
+  const float f2 = f * f;
+  const float r = 12194.f * 12194.f * f2 * f2 /
+                  ((f2 + 20.6f * 20.6f) *
+                   sqrt((f2 + 107.7f * 107.7f) * (f2 + 737.9f * 737.9f)) *
+                   (f2 + 12194.f * 12194.f));
+  return r * 1.2589254f;    // +2.0 dB, normalization at 1 kHz
+}
+
+// log-log curve crosses 0 at e Hz, it is negative below (NaN at 0),
+// and negative weight would flip magnitude sign
+#define LOG_LOG_MIN_FREQ  2.7182818f
+
+void weighting_data(float* weights, const float* freq, size_t n,
+                    enum weighting_curve curve)
+{
+  for (size_t i = 0; i < n; i++) {
+    switch (curve) {
+      case WEIGHTING_LOG_LOG:
+        weights[i] = freq[i] > LOG_LOG_MIN_FREQ ? 2 * math_loglog(freq[i]) : 0;
+        break;
+      case WEIGHTING_A:
+        weights[i] = a_weighting(freq[i]);
+        break;
+      default:
+        weights[i] = 1;
+        break;
+    }
+  }
+}
+
+// channels sum of i-th input sample, mono sample counts for both
+// channels, so both input formats give the same scale
+static inline int32_t input_sum(const struct analysis_cfg* cfg,
+                                const int16_t* raw_input, size_t i)
+{
+  return cfg->mono_input ? 2 * raw_input[i] : raw_input[2*i+0] + raw_input[2*i+1];
+}
+
+// br - FFT bit-reversal permutation table, NULL for time order
+static void prepare_input_samples(const struct analysis_cfg* cfg, size_t offset,
+                                  const int16_t* raw_input, size_t ns,
+                                  const uint16_t* br, float* input)
+{
+  PROFILER_START(t);
+  const float* window = cfg->kwnd;
+  const float k = cfg->preamp / 2.f / 32768.f;
+  // FFT treats each 2 consecutive samples as (re,im) pair, place
+  // pairs at bit-reversed positions if FFT has permutation table
+  for (size_t i = offset; i < offset + ns; i++)
+    input[2*(br ? br[i/2] : i/2) + i%2] = input_sum(cfg, raw_input, i - offset) * k * window[i];
+  PROFILER_LAP(t, PROFILER_PREPARE);
+}
+
+void prepare_fft_input_chunk(const struct analysis_cfg* cfg, size_t offset,
+                             const int16_t* raw_input, size_t ns, float* input)
+{
+  prepare_input_samples(cfg, offset, raw_input, ns, cfg->fft_cfg->br, input);
+}
+
+void prepare_fft_input(const struct analysis_cfg* cfg,
+                       const int16_t* raw_input, float* input)
+{
+  prepare_fft_input_chunk(cfg, 0, raw_input, 2*cfg->fft_cfg->n, input);
+}
+
+void calculate_spectrum(const struct analysis_cfg* cfg, float* fft_buffer)
 {
   // first item in the output is special, its real part is not used,
   // imaginary part (the second array element) is the last magnitude
@@ -46,27 +159,359 @@ static void calculate_spectrum(const struct analysis_cfg* cfg,
 
   float* buf_end = fft_buffer + 2*cfg->fft_cfg->n;
   const float* freq = cfg->freq;
+  const float* weight = cfg->weights;
 
   float* fft_in = fft_buffer + 2;
   float* sp_out = fft_buffer;
   while (sp_out != buf_end) {
     float m = fft_in == buf_end ?
-              last_magnitude : hypot(*fft_in, *(fft_in+1));
+              last_magnitude : math_hypot(*fft_in, *(fft_in+1));
     // scale the magnitude of FFT by window and factor of 2,
     // because we are using half of FFT spectrum
     m = m * 2 / cfg->kwnd_sum;
+    if (weight)
+      m *= *weight++;
     fft_in += 2;
     *sp_out++ = freq ? *freq++ : 0;     // frequency axis
     *sp_out++ = m;                      // raw magnitude
   }
 }
 
+// pruned engine keeps magnitudes on stack until input is processed,
+// it is chosen only for a few bins anyway, see pruned_analysis_max_bins()
+#define PRUNED_MAX_BINS     32
+
+// relative cost of processing one sample by Goertzel algorithm
+// (per bin) and one radix-2 FFT butterfly equivalent (including
+// the share of magnitude calculation), measured with dsp_bench
+#define PRUNED_BIN_COST     5
+#define PRUNED_FFT_COST     9
+
+size_t pruned_analysis_max_bins(size_t nfft)
+{
+  // FFT does (nfft/2 * log2(nfft)) butterflies equivalent,
+  // each Goertzel bin processes all the 2*nfft samples
+  size_t log2n = 0;
+  while ((1u << log2n) < nfft)
+    log2n++;
+  size_t bins = PRUNED_FFT_COST * log2n / (4 * PRUNED_BIN_COST);
+  return bins < PRUNED_MAX_BINS ? bins : PRUNED_MAX_BINS;
+}
+
+// Goertzel algorithm in Reinsch form, which doesn't lose precision
+// at low frequencies, computes squared magnitudes of a few DFT bins
+// at once, bins are independent, so this hides arithmetic latency
+// input - real values in time order, ns in total
+// k - the first DFT bin index, the next ones are k+1, k+2, ...
+// nb - bins count, up to GOERTZEL_BINS
+// power - output, squared magnitudes, nb in total
+#define GOERTZEL_BINS       4
+
+static void goertzel_power(const float* input, size_t ns,
+                           size_t k, size_t nb, float* power)
+{
+  const float pi = acos(-1.f);
+  float lambda[GOERTZEL_BINS];
+  float s[GOERTZEL_BINS];
+  float d[GOERTZEL_BINS];
+  for (size_t j = 0; j < GOERTZEL_BINS; j++) {
+    // -(2 - 2*cos(w)), unused bins are just computed as DC
+    float h = j < nb ? sin(pi * (k + j) / ns) : 0;
+    lambda[j] = -4 * h * h;
+    s[j] = 0;
+    d[j] = 0;
+  }
+
+  for (size_t i = 0; i < ns; i++) {
+    const float x = input[i];
+    for (size_t j = 0; j < GOERTZEL_BINS; j++) {
+      d[j] += lambda[j] * s[j] + x;
+      s[j] += d[j];
+    }
+  }
+
+  for (size_t j = 0; j < nb; j++)
+    power[j] = d[j] * d[j] - lambda[j] * s[j] * (s[j] - d[j]);
+}
+
+// pruned variant of calculate_spectrum(), see ANALYSIS_ENGINE_PRUNED
+// buffer - windowed input in time order, size must be 2*nfft,
+// spectrum **overwrites** it, the same as in calculate_spectrum()
+static void calculate_spectrum_pruned(const struct analysis_cfg* cfg,
+                                      float* buffer)
+{
+  const size_t n = cfg->fft_cfg->n;
+  const size_t ns = 2*n;
+  size_t nb = cfg->exact_bins < n ? cfg->exact_bins : n;
+  if (nb > PRUNED_MAX_BINS)
+    nb = PRUNED_MAX_BINS;
+
+  // input energy and DC, sum of squared magnitudes of all
+  // the other bins is known from them (Parseval's theorem)
+  float energy = 0;
+  float dc = 0;
+  for (size_t i = 0; i < ns; i++) {
+    energy += buffer[i] * buffer[i];
+    dc += buffer[i];
+  }
+  float rest = (ns * energy - dc * dc) / 2;
+
+  float power[PRUNED_MAX_BINS];
+  for (size_t i = 0; i < nb; i += GOERTZEL_BINS) {
+    size_t nj = nb - i < GOERTZEL_BINS ? nb - i : GOERTZEL_BINS;
+    goertzel_power(buffer, ns, i + 1, nj, power + i);
+  }
+  for (size_t i = 0; i < nb; i++)
+    rest -= power[i];
+
+  const float* freq = cfg->freq;
+  for (size_t i = 0; i < n; i++) {
+    float m = 0;
+    if (i < nb)
+      // the same scale as in calculate_spectrum()
+      m = sqrt(power[i]) * 2 / cfg->kwnd_sum;
+    else if (i == nb && rest > 0)
+      // peak of single tone with the same energy,
+      // i.e. divided by window equivalent noise bandwidth
+      m = 2 * sqrt(rest / (ns * cfg->kwnd_sq_sum));
+    if (cfg->weights)
+      m *= cfg->weights[i];
+    *buffer++ = freq ? *freq++ : 0;     // frequency axis
+    *buffer++ = m;                      // raw magnitude
+  }
+}
+
+// fixed-point variant of prepare_fft_input()
+// channels sum multiplied by Q15 window needs 32 bits, result is
+// normalized to 16 bits leaving some headroom for the first FFT pass
+// max_abs - max absolute value in the output
+// returns exponent: input value is (output * 2^exponent)
+static int prepare_fft_input_q15(const struct analysis_cfg* cfg,
+                                 const int16_t* raw_input, int16_t* input,
+                                 int32_t* max_abs)
+{
+  PROFILER_START(t);
+  const size_t n = cfg->fft_q15_cfg->n;
+  const uint16_t* br = cfg->fft_q15_cfg->br;
+  const int16_t* window = cfg->kwnd_q15;
+
+  int32_t m = 0;
+  for (size_t i = 0; i < 2*n; i++) {
+    int32_t v = input_sum(cfg, raw_input, i) * window[i];
+    if (v < 0) v = -v;
+    if (v > m) m = v;
+  }
+
+  int shift = 0;
+  while ((m >> shift) >= (1 << 13))
+    shift++;
+
+  for (size_t i = 0; i < 2*n; i++) {
+    int32_t v = input_sum(cfg, raw_input, i) * window[i];
+    // round to nearest, v is too close to 32 bits to just add 0.5
+    v = shift ? ((v >> (shift - 1)) + 1) >> 1 : v;
+    // the same layout as for float, see prepare_fft_input()
+    input[2*(br ? br[i/2] : i/2) + i%2] = (int16_t)v;
+  }
+
+  *max_abs = shift ? ((m >> (shift - 1)) + 1) >> 1 : m;
+  PROFILER_LAP(t, PROFILER_PREPARE);
+  // (ch1 + ch2) / 2 / 32768 * window / 32768
+  return shift - 31;
+}
+
+// integer square root, rounded down
+static uint32_t isqrt32(uint32_t v)
+{
+  if (v == 0)
+    return 0;
+
+  uint32_t res = 0;
+  // the highest power of 4 <= v
+  uint32_t bit = 1u << ((31 - __builtin_clz(v)) & ~1u);
+  while (bit) {
+    if (v >= res + bit) {
+      v -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
+
+static uint32_t magnitude_q15(const int16_t* c)
+{
+  return isqrt32((int32_t)c[0]*c[0] + (int32_t)c[1]*c[1]);
+}
+
+// fixed-point variant of calculate_spectrum()
+// fft_buffer is the *second* half of spectrum buffer, so output
+// never overwrites not yet processed FFT values
+// exponent - FFT output exponent, output value is (fft * 2^exponent)
+static void calculate_spectrum_q15(const struct analysis_cfg* cfg,
+                                   const int16_t* fft_buffer, int exponent,
+                                   float* spectrum)
+{
+  const size_t n = cfg->fft_q15_cfg->n;
+  const float* freq = cfg->freq;
+  const float* weight = cfg->weights;
+  // scale the magnitude of FFT by window and factor of 2,
+  // because we are using half of FFT spectrum
+  // preamp is linear, so it is just a part of the scale
+  const float scale = ldexp(cfg->preamp * 2 / cfg->kwnd_sum, exponent);
+
+  // the same special first item as in calculate_spectrum()
+  const uint32_t last_magnitude = fft_buffer[1] < 0 ? -fft_buffer[1] : fft_buffer[1];
+
+  for (size_t i = 0; i < n; i++) {
+    uint32_t m = i + 1 == n ?
+                 last_magnitude : magnitude_q15(fft_buffer + 2*(i + 1));
+    *spectrum++ = freq ? *freq++ : 0;   // frequency axis
+    *spectrum++ = m * scale * (weight ? *weight++ : 1.f);  // magnitude
+  }
+}
+
+// does FFT and calculates spectrum from prepared Q15 input
+// fft_buffer - the second half of spectrum buffer with FFT input
+// exponent - FFT input exponent, input value is (fft_buffer * 2^exponent)
+// max_abs - max absolute value in fft_buffer
+static void analyze_prepared_input_q15(const struct analysis_cfg* cfg,
+                                       int16_t* fft_buffer, int exponent,
+                                       int32_t max_abs, float* spectrum)
+{
+  PROFILER_START(t);
+  if (cfg->fft_q15_cfg->br)
+    exponent += fft_real_q15_bitrev(cfg->fft_q15_cfg, fft_buffer, max_abs);
+  else
+    exponent += fft_real_q15(cfg->fft_q15_cfg, fft_buffer);
+  PROFILER_LAP(t, PROFILER_FFT);
+  calculate_spectrum_q15(cfg, fft_buffer, exponent, spectrum);
+  PROFILER_LAP(t, PROFILER_SPECTRUM);
+}
+
+// 16bit FFT data takes only half of the spectrum buffer
+static int16_t* fft_buffer_q15(const struct analysis_cfg* cfg, float* spectrum)
+{
+  return (int16_t*)(spectrum + cfg->fft_q15_cfg->n);
+}
+
+static void analyze_input_q15(const struct analysis_cfg* cfg,
+                              const int16_t* raw_input, float* spectrum)
+{
+  int16_t* fft_buffer = fft_buffer_q15(cfg, spectrum);
+  int32_t max_abs = 0;
+  int exponent = prepare_fft_input_q15(cfg, raw_input, fft_buffer, &max_abs);
+  analyze_prepared_input_q15(cfg, fft_buffer, exponent, max_abs, spectrum);
+}
+
 void analyze_input(const struct analysis_cfg* cfg,
                    const int16_t* raw_input, float* spectrum)
 {
-  prepare_fft_input(cfg, raw_input, spectrum);
-  fft_real(cfg->fft_cfg, spectrum);
-  calculate_spectrum(cfg, spectrum);
+  switch (cfg->engine) {
+    case ANALYSIS_ENGINE_FLOAT:
+      prepare_fft_input(cfg, raw_input, spectrum);
+      analyze_prepared_input(cfg, spectrum);
+      break;
+    case ANALYSIS_ENGINE_Q15:
+      analyze_input_q15(cfg, raw_input, spectrum);
+      break;
+    case ANALYSIS_ENGINE_PRUNED:
+      prepare_input_samples(cfg, 0, raw_input, 2*cfg->fft_cfg->n, NULL, spectrum);
+      analyze_prepared_input(cfg, spectrum);
+      break;
+  }
+}
+
+// Q15 chunks can't be normalized until the whole input is known,
+// so they are stored with the same scale as raw input (full 16 bits)
+// and normalized later, when all the chunks are processed
+static void prepare_input_chunk_q15(const struct analysis_cfg* cfg,
+                                    size_t offset, const int16_t* raw_input,
+                                    size_t ns, float* spectrum)
+{
+  PROFILER_START(t);
+  int16_t* input = fft_buffer_q15(cfg, spectrum);
+  const uint16_t* br = cfg->fft_q15_cfg->br;
+  const int16_t* window = cfg->kwnd_q15;
+  for (size_t i = offset; i < offset + ns; i++) {
+    int32_t v = input_sum(cfg, raw_input, i - offset) * window[i];
+    // the same layout as for float, see prepare_fft_input()
+    input[2*(br ? br[i/2] : i/2) + i%2] = (int16_t)(((v >> 15) + 1) >> 1);
+  }
+  PROFILER_LAP(t, PROFILER_PREPARE);
+}
+
+static void analyze_prepared_input_chunks_q15(const struct analysis_cfg* cfg,
+                                              float* spectrum)
+{
+  PROFILER_START(t);
+  const size_t ns = 2*cfg->fft_q15_cfg->n;
+  int16_t* fft_buffer = fft_buffer_q15(cfg, spectrum);
+
+  int32_t max_abs = 0;
+  for (size_t i = 0; i < ns; i++) {
+    int32_t v = fft_buffer[i] < 0 ? -fft_buffer[i] : fft_buffer[i];
+    if (v > max_abs) max_abs = v;
+  }
+
+  // scale quiet input up, the same range as prepare_fft_input_q15() gives
+  int shift = 0;
+  while (max_abs != 0 && (max_abs << (shift + 1)) < (1 << 13))
+    shift++;
+
+  if (shift) {
+    for (size_t i = 0; i < ns; i++)
+      fft_buffer[i] = fft_buffer[i] * (1 << shift);
+    max_abs <<= shift;
+  }
+  PROFILER_LAP(t, PROFILER_PREPARE);
+
+  // (ch1 + ch2) / 2 / 32768 * window / 32768 * 65536
+  analyze_prepared_input_q15(cfg, fft_buffer, -15 - shift, max_abs, spectrum);
+}
+
+void prepare_input_chunk(const struct analysis_cfg* cfg, size_t offset,
+                         const int16_t* raw_input, size_t ns, float* spectrum)
+{
+  switch (cfg->engine) {
+    case ANALYSIS_ENGINE_FLOAT:
+      prepare_fft_input_chunk(cfg, offset, raw_input, ns, spectrum);
+      break;
+    case ANALYSIS_ENGINE_Q15:
+      prepare_input_chunk_q15(cfg, offset, raw_input, ns, spectrum);
+      break;
+    case ANALYSIS_ENGINE_PRUNED:
+      prepare_input_samples(cfg, offset, raw_input, ns, NULL, spectrum);
+      break;
+  }
+}
+
+void analyze_prepared_input(const struct analysis_cfg* cfg, float* spectrum)
+{
+  PROFILER_START(t);
+  switch (cfg->engine) {
+    case ANALYSIS_ENGINE_FLOAT:
+      if (cfg->fft_real_fn)
+        cfg->fft_real_fn(cfg->fft_cfg, spectrum);
+      else if (cfg->fft_cfg->br)
+        fft_real_bitrev(cfg->fft_cfg, spectrum);
+      else
+        fft_real(cfg->fft_cfg, spectrum);
+      PROFILER_LAP(t, PROFILER_FFT);
+      // weighting is applied in the same pass, no separate stage
+      calculate_spectrum(cfg, spectrum);
+      PROFILER_LAP(t, PROFILER_SPECTRUM);
+      break;
+    case ANALYSIS_ENGINE_Q15:
+      analyze_prepared_input_chunks_q15(cfg, spectrum);
+      break;
+    case ANALYSIS_ENGINE_PRUNED:
+      calculate_spectrum_pruned(cfg, spectrum);
+      PROFILER_LAP(t, PROFILER_SPECTRUM);
+      break;
+  }
 }
 
 void magnitudes_to_decibels(float* spectrum, size_t n)
@@ -75,7 +520,7 @@ void magnitudes_to_decibels(float* spectrum, size_t n)
     float* m = spectrum + 2*i + 1;
     // ref == 1.0 because of float [-1, 1] FFT input
     // add some small value to avoid log(0)
-    *m = 20 * log10(*m / 1.f + 1e-7f);  // convert to dBFS
+    *m = 20 * math_log10(*m / 1.f + 1e-7f);  // convert to dBFS
   }
 }
 
@@ -101,8 +546,10 @@ void spectrum_bars(uint8_t n, float* bars, const uint16_t* bands,
     uint16_t bf = bands[2*i];
     uint16_t bl = bands[2*i + 1];
 
-    if (bf >= nfft || bl >= nfft)
+    if (bf >= nfft || bl >= nfft) {
+      bars[i] = 0;
       continue;
+    }
 
     *(bars + i) = max_in_range(spectrum + 2*bf, spectrum + 2*(bl + 1), 1, 2);
   }
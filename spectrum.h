@@ -4,10 +4,12 @@
 #ifndef _SPECTRUM_H_
 #define _SPECTRUM_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include "simple_fft.h"
+#include "simple_fft_q15.h"
 
 // calculate spectrum frequencies
 // freq - frequencies output buffer, size is n
@@ -15,25 +17,145 @@
 // n - spectrum elements count
 void frequencies_data(float* freq, size_t sample_rate, size_t n);
 
+// window functions applied to input before FFT
+enum window_type {
+  WINDOW_HANN,              // good general purpose window
+  WINDOW_BLACKMAN_HARRIS,   // 4-term, -92 dB sidelobes, wider main lobe
+  WINDOW_FLAT_TOP,          // the most accurate peak amplitudes, widest
+};
+
+// calculate window function coefficients
+// kwnd - coefficients output buffer, size is ns
+// ns - samples count, i.e. 2*nfft
+// type - window function, unknown values are treated as Hann
+// sq_sum - coefficients squares sum output, optional
+// returns coefficients sum
+float window_data(float* kwnd, size_t ns, enum window_type type,
+                  float* sq_sum);
+// the same as window_data(), but coefficients are Q15,
+// returned sums are of the rounded coefficients
+float window_data_q15(int16_t* kwnd, size_t ns, enum window_type type,
+                      float* sq_sum);
+
+// per-bin magnitude weighting curves
+enum weighting_curve {
+  WEIGHTING_LOG_LOG,  // 2*log(log(f)), slowly grows with frequency,
+                      // 0 at e Hz and below (decimated input has such bins)
+  WEIGHTING_A,        // IEC 61672 A-weighting, 1.0 at 1 kHz
+  WEIGHTING_FLAT,     // no weighting, all weights are 1.0
+};
+
+// calculate per-bin magnitude weights
+// weights - weights output buffer, size is n
+// freq - frequencies buffer (see frequencies_data()), size is n
+// n - spectrum elements count
+// curve - weighting curve, unknown values are treated as flat
+void weighting_data(float* weights, const float* freq, size_t n,
+                    enum weighting_curve curve);
+
+// spectrum analysis engine, i.e. FFT algorithm to use
+// engines results are the same within engine's precision
+enum analysis_engine {
+  // float FFT, requires fft_cfg and kwnd
+  ANALYSIS_ENGINE_FLOAT,
+  // fixed-point FFT with block floating point scaling,
+  // requires fft_q15_cfg and kwnd_q15, precision is relative
+  // to the frame: magnitudes absolute error is below 5e-4 of
+  // the largest magnitude (-66 dB) for 128-2048 FFT sizes,
+  // if input is processed by chunks (see prepare_input_chunk())
+  // it is kept in 16 bits before normalization, which gives also
+  // absolute error floor of 1e-5 (-100 dBFS)
+  ANALYSIS_ENGINE_Q15,
+  // float, only the first exact_bins magnitudes are calculated
+  // (Goertzel algorithm), the rest of the spectrum is estimated:
+  // all the remaining energy (Parseval's theorem) is reported as
+  // single peak at index exact_bins, other magnitudes are zero,
+  // the estimate is exact for single tone, and grows up to sqrt
+  // of bins count for wideband signal (i.e. noise), requires
+  // fft_cfg (only n is used), kwnd and kwnd_sq_sum, see also
+  // pruned_analysis_max_bins()
+  ANALYSIS_ENGINE_PRUNED,
+};
+
 // spectrum analysis configuration and data
 struct analysis_cfg {
+  enum analysis_engine engine;    // FFT algorithm to use
   const simple_fft_cfg* fft_cfg;  // FFT algorithm configuration and data
+  const simple_fft_q15_cfg* fft_q15_cfg;  // fixed-point FFT configuration
   const float* kwnd;  // window function coefficients, e.g. Hann window
+  const int16_t* kwnd_q15;  // the same window function coefficients, Q15
   const float* freq;  // spectrum frequencies, FFTs count, optional
   float kwnd_sum;     // window function coefficients sum
   float preamp;       // input amplification, [0...2]
+  float kwnd_sq_sum;  // window function coefficients squares sum
+  uint16_t exact_bins;  // magnitudes count calculated by pruned engine
+  const float* weights; // magnitudes weights, FFTs count, optional
+  // float engine FFT, optional, replaces fft_real_bitrev() (or
+  // fft_real() if fft_cfg has no bit-reversal table), e.g. one
+  // specialized for FFT size, see simple_fft_fixed.hpp
+  void (*fft_real_fn)(const simple_fft_cfg* cfg, float* data);
+  // raw input is mono (channels average, see audio_ingest.h)
+  // instead of stereo, raw input arrays are half as long then
+  bool mono_input;
 };
 
+// max exact_bins value pruned engine is faster than FFT with
+// nfft - FFTs count, the same as in FFT configuration
+size_t pruned_analysis_max_bins(size_t nfft);
+
 // analyze input and calculate the spectrum
 // calculations are done according to given FFT configuration
 // implementation depends on used FFT algorithm
-// returned amplitude values are normalized magnitudes
+// returned amplitude values are normalized magnitudes,
+// multiplied by weights if configuration has them
 // cfg - spectrum analysis configuration and data
-// raw_input - 16bit stereo input, number of samples must be 2*nfft
+// raw_input - 16bit stereo (or mono, see mono_input) input,
+//             number of samples must be 2*nfft
 // spectrum - output array of (0,amplitude) pairs, nfft in total
 void analyze_input(const struct analysis_cfg* cfg,
                    const int16_t* raw_input, float* spectrum);
 
+// incremental variant of analyze_input(), allows to process input
+// as it arrives, without collecting it in some intermediate buffer
+// prepare_input_chunk() must be called for each chunk of input,
+// then analyze_prepared_input() does the rest of analyze_input()
+// cfg - spectrum analysis configuration and data
+// offset - index of the first chunk sample (pair) in the whole input
+// raw_input - 16bit stereo (or mono) input chunk, ns samples
+// ns - samples count in chunk, offset + ns must not exceed 2*nfft
+// spectrum - the same buffer as for analyze_input(), the same for all calls
+void prepare_input_chunk(const struct analysis_cfg* cfg, size_t offset,
+                         const int16_t* raw_input, size_t ns, float* spectrum);
+void analyze_prepared_input(const struct analysis_cfg* cfg, float* spectrum);
+
+// analyze_input() stages for float engine, exposed mostly for benchmarking,
+// analyze_input() is just these calls with fft_real() (or fft_real_bitrev()
+// if FFT configuration has bit-reversal table) in between
+
+// converts raw_input into the form expected by FFT algorithm
+// implementation depends on FFT algorithm input format
+// if FFT configuration has bit-reversal permutation table,
+// output is in bit-reversed order, i.e. for fft_real_bitrev()
+// raw_input - 16bit stereo (or mono) input, 2*nfft samples
+// input - output buffer where prepared data should be written
+// ns - samples count (i.e. number of *pairs* in stereo raw_input)
+// raw_input size is 2*ns, window and input size is ns
+void prepare_fft_input(const struct analysis_cfg* cfg,
+                       const int16_t* raw_input, float* input);
+
+// the same as prepare_fft_input(), but processes only part of the input
+// offset - index of the first raw_input sample in the whole input
+// ns - samples count (i.e. number of *pairs* in stereo raw_input)
+void prepare_fft_input_chunk(const struct analysis_cfg* cfg, size_t offset,
+                             const int16_t* raw_input, size_t ns, float* input);
+
+// process FFT output buffer and calculates spectrum
+// implementation depends on FFT algorithm output format
+// expected format the same as KISSFFT C++ produces for real data input
+// spectrum data **overwrites** FFT data, amplitudes are at odd indexes
+// fft_buffer - FFT algorithm output buffer, size must be 2*nfft
+void calculate_spectrum(const struct analysis_cfg* cfg, float* fft_buffer);
+
 // convert magnitudes to amplitudes in decibels in-place
 // spectrum - input array of (freq,magnitude) pairs, n in total
 // n - spectrum elements (i.e. pairs) count, array size / 2
@@ -42,7 +164,8 @@ void magnitudes_to_decibels(float* spectrum, size_t n);
 // create spectrum "bars" representation
 // n - desired bars count
 // bars - output buffer, size must be n
-// bands - list of n [first index, last index] *pairs* for each bar
+// bands - list of n [first index, last index] *pairs* for each bar,
+//         bars of bands beyond spectrum are 0
 // spectrum - source spectrum, it should be large enough to contain max index
 // nfft - number of (freq,amplitude) pairs in spectrum, FFTs count
 void spectrum_bars(uint8_t n, float* bars, const uint16_t* bands,
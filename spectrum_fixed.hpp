@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _SPECTRUM_FIXED_HPP_
+#define _SPECTRUM_FIXED_HPP_
+
+#include <array>
+#include <iterator>
+
+#include "simple_fft_fixed.hpp"
+
+extern "C" {
+#include "spectrum.h"
+}
+
+// compile-time generated window tables for fixed block size (C++17)
+// the same coefficients and sums window_data() and window_data_q15()
+// give, e.g. for analysis_cfg:
+//   using wnd = window_fixed<1024, WINDOW_HANN>;
+//   acfg.kwnd = wnd::kwnd.data();
+//   acfg.kwnd_sum = wnd::sum;
+//   acfg.kwnd_sq_sum = wnd::sq_sum;
+
+template<size_t NS, enum window_type W>
+struct window_fixed {
+  static_assert(NS >= 2, "window size is too small");
+
+  // generalized cosine window coefficient, see spectrum.c
+  static constexpr double coefficient(size_t i)
+  {
+    constexpr double hann[] = {0.5, 0.5};
+    constexpr double blackman_harris[] = {0.35875, 0.48829, 0.14128, 0.01168};
+    constexpr double flat_top[] = {
+      0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368,
+    };
+
+    const double* a = hann;
+    size_t n = std::size(hann);
+    if (W == WINDOW_BLACKMAN_HARRIS) {
+      a = blackman_harris;
+      n = std::size(blackman_harris);
+    }
+    if (W == WINDOW_FLAT_TOP) {
+      a = flat_top;
+      n = std::size(flat_top);
+    }
+
+    double w = 0;
+    for (size_t k = 0; k < n; k++) {
+      const double c = simple_fft_ct::sincos_pi(2*k*i, NS - 1).cos;
+      w += (k % 2 ? -a[k] : a[k]) * c;
+    }
+    return w;
+  }
+
+  static constexpr std::array<float, NS> make_kwnd()
+  {
+    std::array<float, NS> kwnd = {};
+    for (size_t i = 0; i < NS; i++)
+      kwnd[i] = (float)coefficient(i);
+    return kwnd;
+  }
+
+  static constexpr std::array<int16_t, NS> make_kwnd_q15()
+  {
+    std::array<int16_t, NS> kwnd = {};
+    for (size_t i = 0; i < NS; i++)
+      kwnd[i] = simple_fft_ct::q15_from_double(coefficient(i));
+    return kwnd;
+  }
+
+  // sum of coefficients, or their squares, as they are in the table
+  template<typename T, size_t S>
+  static constexpr float table_sum(const std::array<T, S>& kwnd,
+                                  double scale, bool squares)
+  {
+    double sum = 0;
+    for (size_t i = 0; i < S; i++) {
+      const double k = kwnd[i] / scale;
+      sum += squares ? k * k : k;
+    }
+    return (float)sum;
+  }
+
+  static constexpr std::array<float, NS> kwnd = make_kwnd();
+  static constexpr float sum = table_sum(kwnd, 1, false);
+  static constexpr float sq_sum = table_sum(kwnd, 1, true);
+
+  static constexpr std::array<int16_t, NS> kwnd_q15 = make_kwnd_q15();
+  static constexpr float sum_q15 = table_sum(kwnd_q15, 32768, false);
+  static constexpr float sq_sum_q15 = table_sum(kwnd_q15, 32768, true);
+};
+
+#endif  // _SPECTRUM_FIXED_HPP_
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "spsc_queue.h"
+
+#include <string.h>
+
+// GCC atomic builtins, they work on plain fields, so the header
+// is usable from C++ code too (C11 atomics are not)
+#define load_acquire(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define load_relaxed(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+void spsc_queue_init(struct spsc_queue* q, void* buffer,
+                     size_t item_size, uint32_t capacity)
+{
+  q->buffer = buffer;
+  q->item_size = item_size;
+  q->capacity = capacity;
+  q->head = 0;
+  q->tail = 0;
+}
+
+static inline uint8_t* item_at(const struct spsc_queue* q, uint32_t pos)
+{
+  return q->buffer + (size_t)(pos & (q->capacity - 1)) * q->item_size;
+}
+
+bool spsc_queue_push(struct spsc_queue* q, const void* item)
+{
+  // tail is written only by this side
+  const uint32_t tail = load_relaxed(&q->tail);
+  // item at head is not free until consumer has copied it out
+  const uint32_t head = load_acquire(&q->head);
+
+  if (tail - head == q->capacity)
+    return false;
+
+  memcpy(item_at(q, tail), item, q->item_size);
+  // item data must be visible before the new tail
+  store_release(&q->tail, tail + 1);
+  return true;
+}
+
+bool spsc_queue_pop(struct spsc_queue* q, void* item)
+{
+  const uint32_t head = load_relaxed(&q->head);
+  const uint32_t tail = load_acquire(&q->tail);
+
+  if (head == tail)
+    return false;
+
+  memcpy(item, item_at(q, head), q->item_size);
+  // slot may be reused by producer only after it is copied out
+  store_release(&q->head, head + 1);
+  return true;
+}
+
+uint32_t spsc_queue_size(const struct spsc_queue* q)
+{
+  return load_acquire(&q->tail) - load_acquire(&q->head);
+}
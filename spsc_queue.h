@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2025 Nick Korotysh <nick.korotysh@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// lock-free single-producer / single-consumer queue of fixed size items
+// push() may be called only by one thread (task), pop() only by another,
+// no locks and no waiting, items are copied in and out of the queue
+// head and tail are free-running counters, each one is written only by
+// its owner, other side reads it with acquire semantics
+struct spsc_queue {
+  uint8_t* buffer;    // items storage, capacity * item_size bytes
+  size_t item_size;   // item size, bytes
+  uint32_t capacity;  // max items count, must be power of 2
+  uint32_t head;      // the next item to pop, written by consumer
+  uint32_t tail;      // the next item to push, written by producer
+};
+
+// initializes empty queue
+// buffer - items storage, capacity * item_size bytes
+// item_size - item size, bytes
+// capacity - max items count, must be power of 2
+void spsc_queue_init(struct spsc_queue* q, void* buffer,
+                     size_t item_size, uint32_t capacity);
+
+// copies item into the queue, producer side
+// returns false if queue is full, item is not added then
+bool spsc_queue_push(struct spsc_queue* q, const void* item);
+
+// copies the oldest item out of the queue and removes it, consumer side
+// returns false if queue is empty, item is not changed then
+bool spsc_queue_pop(struct spsc_queue* q, void* item);
+
+// items count in the queue, exact only from producer or consumer
+// point of view, i.e. it may only grow for consumer and shrink for
+// producer while it is being used
+uint32_t spsc_queue_size(const struct spsc_queue* q);
+
+#endif /* _SPSC_QUEUE_H_ */